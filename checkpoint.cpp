@@ -0,0 +1,187 @@
+#include "checkpoint.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHECKPOINT_MMAP 1
+#endif
+
+namespace {
+const char kMagic[8] = {'C', 'S', 'O', 'P', 'C', 'K', 'P', 'T'};
+const uint32_t kByteOrderMark = 0x01020304;
+const size_t kInitialBufferSize = 1 << 20; // The buffer grows with the snapshot
+const uint64_t kFnvOffset = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t fnv1a(uint64_t hash, const unsigned char* bytes, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : path(path), temp_path(path + ".tmp"), checksum(kFnvOffset) {
+    file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) return;
+    buffer.reserve(kInitialBufferSize);
+    append(kMagic, sizeof(kMagic));
+    put(kCheckpointVersion);
+    put(kByteOrderMark);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (!file) return;
+    std::fclose(file); // Abandoned before finish(); the old snapshot stays
+    std::remove(temp_path.c_str());
+}
+
+void CheckpointWriter::append(const void* data, size_t size) {
+    if (!ok()) return;
+    const char* bytes = static_cast<const char*>(data);
+    checksum = fnv1a(checksum, reinterpret_cast<const unsigned char*>(bytes), size);
+    written += size;
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void CheckpointWriter::putBits(const std::vector<bool>& bits) {
+    put<uint64_t>(bits.size());
+    std::vector<unsigned char> packed((bits.size() + 7) / 8, 0);
+    for (size_t i = 0; i < bits.size(); ++i) {
+        if (bits[i]) packed[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+    }
+    if (!packed.empty()) append(packed.data(), packed.size());
+}
+
+void CheckpointWriter::putString(const std::string& text) {
+    put<uint64_t>(text.size());
+    append(text.data(), text.size());
+}
+
+bool CheckpointWriter::finish() {
+    if (!file) return false;
+    uint64_t sum = checksum;
+    append(&sum, sizeof(sum));
+    if (ok() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+    std::vector<char>().swap(buffer);
+    if (std::fflush(file) != 0) failed = true;
+#ifdef CHECKPOINT_MMAP
+    if (!failed && fsync(fileno(file)) != 0) failed = true;
+#endif
+    bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!closed || failed || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+CheckpointReader::~CheckpointReader() {
+    close();
+}
+
+void CheckpointReader::close() {
+#ifdef CHECKPOINT_MMAP
+    if (mapped && data) munmap(const_cast<unsigned char*>(data), mapped_size);
+#endif
+    mapped = false;
+    data = nullptr;
+    fallback.clear();
+}
+
+bool CheckpointReader::open(const std::string& path, std::string& error) {
+    close();
+    failed = true;
+#ifdef CHECKPOINT_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        error = path + " is empty";
+        return false;
+    }
+    mapped_size = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file open
+    if (view == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+    data = static_cast<const unsigned char*>(view);
+    mapped = true;
+#else
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    mapped_size = fallback.size();
+    data = fallback.empty() ? nullptr : &fallback[0];
+#endif
+
+    size_t header = sizeof(kMagic) + 2 * sizeof(uint32_t);
+    if (mapped_size < header + sizeof(uint64_t) || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a checkpoint";
+        return false;
+    }
+    end = mapped_size - sizeof(uint64_t);
+    uint64_t stored;
+    std::memcpy(&stored, data + end, sizeof(stored));
+    if (fnv1a(kFnvOffset, data, end) != stored) {
+        error = path + " is truncated or corrupt (checksum mismatch)";
+        return false;
+    }
+
+    failed = false;
+    pos = sizeof(kMagic);
+    file_version = get<uint32_t>();
+    if (get<uint32_t>() != kByteOrderMark) {
+        error = path + " was written on a host with a different byte order";
+        return fail();
+    }
+    if (file_version != kCheckpointVersion) {
+        error = path + " is checkpoint version " + std::to_string(file_version) + "; this build reads version " +
+                std::to_string(kCheckpointVersion);
+        return fail();
+    }
+    return true;
+}
+
+bool CheckpointReader::take(uint64_t size) {
+    if (failed || size > end - pos) return fail();
+    pos += static_cast<size_t>(size);
+    return true;
+}
+
+bool CheckpointReader::getBits(std::vector<bool>& bits, uint64_t max_count) {
+    uint64_t count = get<uint64_t>();
+    uint64_t bytes = (count + 7) / 8;
+    if (count > max_count || !take(bytes)) return fail();
+    const unsigned char* packed = data + pos - bytes;
+    bits.assign(static_cast<size_t>(count), false);
+    for (size_t i = 0; i < bits.size(); ++i) {
+        bits[i] = (packed[i / 8] >> (i % 8)) & 1;
+    }
+    return true;
+}
+
+std::string CheckpointReader::getString() {
+    uint64_t size = get<uint64_t>();
+    if (!take(size)) return std::string();
+    return std::string(reinterpret_cast<const char*>(data + pos - size), static_cast<size_t>(size));
+}
+
+bool CheckpointReader::expectSection(uint32_t tag) {
+    if (get<uint32_t>() != tag) return fail();
+    return ok();
+}
@@ -0,0 +1,126 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Versioned binary snapshot of the emulator. Layout:
+//   "CSOPCKPT"   8-byte magic
+//   version      uint32
+//   byte order   uint32 0x01020304 as written by the host; other byte orders are rejected
+//   payload      fields in the order the writer put them, each section led by a uint32 tag
+//   checksum     uint64 FNV-1a over everything before it
+// Numbers are stored in host byte order at their native width; vectors and strings are a
+// uint64 element count followed by the raw elements.
+
+const uint32_t kCheckpointVersion = 4;
+
+// Builds a snapshot front to back in memory; nothing reaches the disk until finish(), so a
+// caller can serialize under its locks and do the file I/O after releasing them. The bytes
+// go to path + ".tmp", which finish() syncs and renames over path, so a crash or a failed
+// write never leaves a truncated snapshot where a good one was.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    bool ok() const { return file != nullptr && !failed; }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_arithmetic<T>::value, "put takes numbers; use putString/putVector");
+        append(&value, sizeof(value));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+        static_assert(std::is_arithmetic<T>::value, "putVector takes vectors of numbers");
+        put<uint64_t>(values.size());
+        if (!values.empty()) append(values.data(), values.size() * sizeof(T));
+    }
+
+    void putBits(const std::vector<bool>& bits);
+    void putString(const std::string& text);
+    void section(uint32_t tag) { put(tag); }
+
+    // Appends the checksum, writes and syncs the file and moves it into place; false if any
+    // step failed, in which case path is left as it was
+    bool finish();
+
+    uint64_t bytesWritten() const { return written; }
+
+private:
+    void append(const void* data, size_t size);
+
+    std::string path;
+    std::string temp_path;
+    FILE* file = nullptr;
+    bool failed = false;
+    std::vector<char> buffer;   // The whole snapshot until finish()
+    uint64_t checksum;
+    uint64_t written = 0;
+};
+
+// Reads a snapshot in place from a read-only memory mapping. Every read is bounds-checked;
+// the first bad read marks the reader failed and later reads return zeros.
+class CheckpointReader {
+public:
+    CheckpointReader() {}
+    ~CheckpointReader();
+
+    // Maps the file and checks magic, version, byte order and checksum; on failure error says why
+    bool open(const std::string& path, std::string& error);
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return pos == end; }
+    uint32_t version() const { return file_version; }
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_arithmetic<T>::value, "get reads numbers");
+        T value = T();
+        if (take(sizeof(value))) std::memcpy(&value, data + pos - sizeof(value), sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    bool getVector(std::vector<T>& values, uint64_t max_count) {
+        static_assert(std::is_arithmetic<T>::value, "getVector reads vectors of numbers");
+        uint64_t count = get<uint64_t>();
+        if (count > max_count || !take(count * sizeof(T))) return fail();
+        values.resize(static_cast<size_t>(count));
+        if (count > 0) std::memcpy(&values[0], data + pos - count * sizeof(T), count * sizeof(T));
+        return true;
+    }
+
+    bool getBits(std::vector<bool>& bits, uint64_t max_count);
+    std::string getString();
+
+    // Consumes a section tag; fails the reader if it is not the expected one
+    bool expectSection(uint32_t tag);
+
+private:
+    CheckpointReader(const CheckpointReader&);
+    CheckpointReader& operator=(const CheckpointReader&);
+
+    bool take(uint64_t size);
+    bool fail() {
+        failed = true;
+        return false;
+    }
+    void close();
+
+    const unsigned char* data = nullptr;
+    size_t mapped_size = 0;
+    bool mapped = false;                 // false when the file was read into fallback instead
+    std::vector<unsigned char> fallback;
+    size_t pos = 0, end = 0;             // end excludes the checksum
+    uint32_t file_version = 0;
+    bool failed = true;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,471 @@
+#include "clusterManager.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+const int kAcceptPollMs = 200;  // How often the node thread checks for stop
+const int kIoTimeoutMs = 1000;  // A peer that takes longer than this is treated as down
+const size_t kMaxMovesPerRound = 8;
+const size_t kMaxLineBytes = 4096;
+
+bool fillAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+void setTimeouts(int fd) {
+    timeval timeout;
+    timeout.tv_sec = kIoTimeoutMs / 1000;
+    timeout.tv_usec = (kIoTimeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads lines until the "." terminator (or, for a request, the first line)
+bool readLines(int fd, std::vector<std::string>& lines, bool until_terminator) {
+    std::string line;
+    char buffer[1024];
+    while (true) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        for (ssize_t i = 0; i < n; ++i) {
+            if (buffer[i] != '\n') {
+                if (line.size() >= kMaxLineBytes) return false;
+                line += buffer[i];
+                continue;
+            }
+            if (!until_terminator) {
+                lines.push_back(line);
+                return true;
+            }
+            if (line == ".") return true;
+            lines.push_back(line);
+            line.clear();
+        }
+    }
+}
+
+// One request to the node at path; reply holds the lines before the terminator
+bool request(const std::string& path, const std::string& line, std::vector<std::string>& reply) {
+    sockaddr_un address;
+    if (!fillAddress(path, address)) return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    setTimeouts(fd);
+    bool ok = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+              writeAll(fd, line + "\n") && readLines(fd, reply, true);
+    close(fd);
+    return ok;
+}
+
+std::string statusLine(const NodeStatus& status) {
+    std::ostringstream line;
+    line << "name=" << status.name << " cores=" << status.cores << " running=" << status.running
+         << " ready=" << status.ready << " pending=" << status.pending << " live=" << status.live
+         << " finished=" << status.finished << " used=" << status.used_memory << " max=" << status.max_memory
+         << " active=" << status.active_ticks << " idle=" << status.idle_ticks << " in=" << status.migrated_in
+         << " out=" << status.migrated_out;
+    return line.str();
+}
+
+bool parseStatus(const std::string& line, NodeStatus& status) {
+    std::istringstream in(line);
+    std::string field;
+    std::map<std::string, std::string> values;
+    while (in >> field) {
+        size_t equals = field.find('=');
+        if (equals != std::string::npos) values[field.substr(0, equals)] = field.substr(equals + 1);
+    }
+    if (!values.count("name") || !values.count("cores")) return false;
+    status.name = values["name"];
+    status.cores = std::atoi(values["cores"].c_str());
+    status.running = std::atoi(values["running"].c_str());
+    status.ready = std::atoi(values["ready"].c_str());
+    status.pending = std::atoi(values["pending"].c_str());
+    status.live = std::atoi(values["live"].c_str());
+    status.finished = std::atoi(values["finished"].c_str());
+    status.used_memory = std::atoll(values["used"].c_str());
+    status.max_memory = std::atoll(values["max"].c_str());
+    status.active_ticks = std::atoll(values["active"].c_str());
+    status.idle_ticks = std::atoll(values["idle"].c_str());
+    status.migrated_in = std::atoll(values["in"].c_str());
+    status.migrated_out = std::atoll(values["out"].c_str());
+    return true;
+}
+
+std::string processLine(const MigratedProcess& process) {
+    std::ostringstream line;
+    line << process.name << " " << process.instructions << " " << process.memory << " " << process.current_step
+         << " " << process.priority << " " << process.deadline << " " << process.age_ms;
+    return line.str();
+}
+
+bool parseProcess(std::istream& in, MigratedProcess& process) {
+    return static_cast<bool>(in >> process.name >> process.instructions >> process.memory >> process.current_step >>
+                             process.priority >> process.deadline >> process.age_ms);
+}
+}
+
+std::string clusterName(const std::string& node, const std::string& name) {
+    return name.find('/') == std::string::npos ? node + "/" + name : name;
+}
+
+std::string nodeNameFromPath(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+ClusterNode::~ClusterNode() {
+    stop();
+}
+
+bool ClusterNode::start(const std::string& socket_path, ClusterHost* cluster_host) {
+    stop();
+    sockaddr_un address;
+    if (!fillAddress(socket_path, address)) return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    unlink(socket_path.c_str()); // Left behind by an instance that did not shut down cleanly
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return false;
+    }
+    path = socket_path;
+    host = cluster_host;
+    listener = fd;
+    active.store(true);
+    worker = std::thread(&ClusterNode::loop, this);
+    return true;
+}
+
+void ClusterNode::stop() {
+    active.store(false);
+    if (worker.joinable()) worker.join();
+    if (listener >= 0) {
+        close(listener);
+        listener = -1;
+        unlink(path.c_str());
+    }
+}
+
+void ClusterNode::loop() {
+    while (active.load()) {
+        pollfd waiting;
+        waiting.fd = listener;
+        waiting.events = POLLIN;
+        waiting.revents = 0;
+        if (::poll(&waiting, 1, kAcceptPollMs) <= 0) continue;
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) continue;
+        setTimeouts(connection);
+        serve(connection);
+        close(connection);
+    }
+}
+
+void ClusterNode::serve(int connection) {
+    std::vector<std::string> lines;
+    if (!readLines(connection, lines, false)) return;
+    std::istringstream in(lines[0]);
+    std::string verb;
+    in >> verb;
+
+    std::ostringstream reply;
+    if (verb == "STATUS") {
+        reply << statusLine(host->clusterStatus()) << "\n";
+    } else if (verb == "PS") {
+        for (const auto& process : host->clusterProcesses()) {
+            reply << process.name << " " << process.core << " " << process.current_step << " "
+                  << process.total_instructions << " " << process.state << "\n";
+        }
+    } else if (verb == "ADOPT") {
+        MigratedProcess process;
+        reply << (parseProcess(in, process) && host->adoptProcess(process) ? "OK" : "REFUSED") << "\n";
+    } else if (verb == "GIVE") {
+        size_t count = 0;
+        in >> count;
+        std::vector<MigratedProcess> given;
+        host->releaseQueued(std::min(count, kMaxMovesPerRound), given);
+        for (const auto& process : given) reply << processLine(process) << "\n";
+    } else {
+        reply << "ERROR unknown request\n";
+    }
+    reply << ".\n";
+    writeAll(connection, reply.str());
+}
+
+ClusterCoordinator::~ClusterCoordinator() {
+    stop();
+}
+
+void ClusterCoordinator::start(ClusterHost* cluster_host, const std::vector<std::string>& peer_paths,
+                               int balance_interval_ms, double max_imbalance) {
+    stop();
+    host = cluster_host;
+    balance_ms = std::max(100, balance_interval_ms);
+    imbalance = std::max(0.5, max_imbalance);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        peers.clear();
+        for (const auto& path : peer_paths) {
+            Peer peer;
+            peer.path = path;
+            peer.status.name = nodeNameFromPath(path);
+            peers.push_back(peer);
+        }
+    }
+    poll(); // So the first placements already see the peers
+    active.store(true);
+    worker = std::thread(&ClusterCoordinator::loop, this);
+}
+
+void ClusterCoordinator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        active.store(false);
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void ClusterCoordinator::loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (active.load()) {
+        wake.wait_for(lock, std::chrono::milliseconds(balance_ms), [this] { return !active.load(); });
+        if (!active.load()) break;
+        lock.unlock();
+        poll();
+        balance();
+        lock.lock();
+    }
+}
+
+bool ClusterCoordinator::queryStatus(const std::string& path, NodeStatus& status) const {
+    std::vector<std::string> reply;
+    return request(path, "STATUS", reply) && !reply.empty() && parseStatus(reply[0], status);
+}
+
+// Sockets are queried without mtx, so placements are never held up by a slow peer
+void ClusterCoordinator::poll() {
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& peer : peers) paths.push_back(peer.path);
+    }
+    std::vector<NodeStatus> statuses(paths.size());
+    std::vector<bool> reachable(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        reachable[i] = queryStatus(paths[i], statuses[i]);
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < peers.size() && i < paths.size(); ++i) {
+        peers[i].reachable = reachable[i];
+        if (reachable[i]) peers[i].status = statuses[i];
+    }
+}
+
+// The local node first, then every reachable peer; peer_of maps back to peers (-1 = local)
+size_t ClusterCoordinator::gatherStatus(std::vector<NodeStatus>& nodes, std::vector<int>& peer_of) {
+    nodes.clear();
+    peer_of.clear();
+    nodes.push_back(host->clusterStatus());
+    peer_of.push_back(-1);
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < peers.size(); ++i) {
+        if (!peers[i].reachable) continue;
+        nodes.push_back(peers[i].status);
+        peer_of.push_back(static_cast<int>(i));
+    }
+    return nodes.size();
+}
+
+int ClusterCoordinator::choosePlacement(int memory) {
+    NodeStatus local = host->clusterStatus();
+    std::lock_guard<std::mutex> lock(mtx);
+    int best = -1;
+    double best_load = local.load();
+    bool best_fits = local.freeMemory() >= memory;
+    for (size_t i = 0; i < peers.size(); ++i) {
+        if (!peers[i].reachable) continue;
+        const NodeStatus& status = peers[i].status;
+        bool fits = status.freeMemory() >= memory;
+        // Nodes with room come first; among equals, the lightest load
+        if ((fits && !best_fits) || (fits == best_fits && status.load() < best_load)) {
+            best = static_cast<int>(i);
+            best_load = status.load();
+            best_fits = fits;
+        }
+    }
+    if (best >= 0) {
+        // Count it now so one batch does not all land on the same node before the next poll
+        ++peers[best].status.live;
+        peers[best].status.used_memory += memory;
+        ++placements;
+    }
+    return best;
+}
+
+bool ClusterCoordinator::sendTo(int peer, const MigratedProcess& process) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (peer < 0 || peer >= static_cast<int>(peers.size())) return false;
+        path = peers[peer].path;
+    }
+    std::vector<std::string> reply;
+    if (request(path, "ADOPT " + processLine(process), reply) && !reply.empty() && reply[0] == "OK") return true;
+    std::lock_guard<std::mutex> lock(mtx);
+    peers[peer].reachable = false; // Placed locally until the next poll says otherwise
+    return false;
+}
+
+// Moves queued processes from the most to the least loaded node when their load per core
+// differs by at least imbalance. Processes that the target refuses go back where they came from.
+void ClusterCoordinator::balance() {
+    std::vector<NodeStatus> nodes;
+    std::vector<int> peer_of;
+    if (gatherStatus(nodes, peer_of) < 2) return;
+    size_t busiest = 0, idlest = 0;
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        if (nodes[i].load() > nodes[busiest].load()) busiest = i;
+        if (nodes[i].load() < nodes[idlest].load()) idlest = i;
+    }
+    double gap = nodes[busiest].load() - nodes[idlest].load();
+    if (busiest == idlest || gap < imbalance) return;
+    int cores = std::min(nodes[busiest].cores, nodes[idlest].cores);
+    size_t count = std::min(kMaxMovesPerRound, std::max<size_t>(1, static_cast<size_t>(gap * cores / 2)));
+
+    std::vector<MigratedProcess> moving;
+    int from = peer_of[busiest], to = peer_of[idlest];
+    if (from < 0) {
+        host->releaseQueued(count, moving);
+    } else {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            path = peers[from].path;
+        }
+        std::vector<std::string> reply;
+        if (!request(path, "GIVE " + std::to_string(count), reply)) return;
+        for (const auto& line : reply) {
+            std::istringstream in(line);
+            MigratedProcess process;
+            if (parseProcess(in, process)) moving.push_back(process);
+        }
+    }
+
+    for (auto& process : moving) {
+        process.name = clusterName(nodes[busiest].name, process.name);
+        bool moved = to < 0 ? host->adoptProcess(process) : sendTo(to, process);
+        if (!moved) {
+            // Back to the node it left; a local process can always be taken back
+            if (from < 0 || !sendTo(from, process)) host->adoptProcess(process);
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        ++migrations;
+    }
+}
+
+void ClusterCoordinator::writeScreenList(std::ostream& out) {
+    std::vector<Peer> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        snapshot = peers;
+    }
+    for (const auto& peer : snapshot) {
+        out << "-------------------------------------------------------------------------\n";
+        std::vector<std::string> reply;
+        if (!request(peer.path, "PS", reply)) {
+            out << "Node " << peer.status.name << " (" << peer.path << "): unreachable\n";
+            continue;
+        }
+        out << "Node " << peer.status.name << " (" << peer.path << "): " << reply.size() << " live processes\n";
+        for (const auto& line : reply) {
+            std::istringstream in(line);
+            NodeProcess process;
+            if (!(in >> process.name >> process.core >> process.current_step >> process.total_instructions >>
+                  process.state)) {
+                continue;
+            }
+            out << process.name << " Core: " << process.core << "   " << process.current_step << " / "
+                << process.total_instructions << " [" << process.state << "]\n";
+        }
+    }
+}
+
+void ClusterCoordinator::writeVmstat(std::ostream& out) {
+    poll();
+    std::vector<NodeStatus> nodes;
+    std::vector<int> peer_of;
+    gatherStatus(nodes, peer_of);
+    NodeStatus total;
+    total.name = "cluster";
+    out << "------------------------------------------\n";
+    out << "Cluster: " << nodes.size() << " reachable nodes\n";
+    out << std::left << std::setw(14) << "Node" << std::right << std::setw(6) << "Cores" << std::setw(7) << "Live"
+        << std::setw(7) << "Load" << std::setw(20) << "Memory used/max" << std::setw(10) << "Active"
+        << std::setw(10) << "Idle" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i <= nodes.size(); ++i) {
+        const NodeStatus& node = i < nodes.size() ? nodes[i] : total;
+        if (i < nodes.size()) {
+            total.cores += node.cores;
+            total.live += node.live;
+            total.used_memory += node.used_memory;
+            total.max_memory += node.max_memory;
+            total.active_ticks += node.active_ticks;
+            total.idle_ticks += node.idle_ticks;
+        }
+        std::string memory = std::to_string(node.used_memory / 1024) + "/" + std::to_string(node.max_memory / 1024) + " KiB";
+        out << std::left << std::setw(14) << node.name << std::right << std::setw(6) << node.cores << std::setw(7)
+            << node.live << std::setw(7) << node.load() << std::setw(20) << memory << std::setw(10)
+            << node.active_ticks << std::setw(10) << node.idle_ticks << "\n";
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+void ClusterCoordinator::writeStatus(std::ostream& out) {
+    writeVmstat(out);
+    std::lock_guard<std::mutex> lock(mtx);
+    out << "Placed on peers: " << placements << ", migrated between nodes: " << migrations << "\n";
+    for (const auto& peer : peers) {
+        if (!peer.reachable) out << "Unreachable: " << peer.path << "\n";
+    }
+}
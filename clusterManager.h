@@ -0,0 +1,147 @@
+#ifndef CLUSTER_MANAGER_H
+#define CLUSTER_MANAGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Several emulator instances on one machine form a cluster over Unix domain sockets. Every
+// instance with cluster-socket set serves its node; the one that also lists cluster-peers is
+// the coordinator. It places new processes on the node with the lowest load that has the
+// memory for them, moves queued processes off overloaded nodes, and aggregates screen -ls
+// and vmstat. Requests are one text line per connection; replies end with a "." line.
+
+// Load figures one node reports to the coordinator
+struct NodeStatus {
+    std::string name;
+    int cores = 0;
+    int running = 0;
+    int ready = 0;
+    int pending = 0;
+    int live = 0;
+    int finished = 0;
+    long long used_memory = 0, max_memory = 0;
+    long long active_ticks = 0, idle_ticks = 0;
+    long long migrated_in = 0, migrated_out = 0;
+
+    // Runnable and waiting processes per core
+    double load() const { return cores > 0 ? static_cast<double>(live) / cores : 0.0; }
+    long long freeMemory() const { return max_memory - used_memory; }
+};
+
+// A process on its way to another node: what it needs and how far it got. Names carry the
+// node they were created on, e.g. "a/process12".
+struct MigratedProcess {
+    std::string name;
+    int instructions = 0;
+    int memory = 0;
+    int current_step = 0;
+    int priority = 0;
+    long long deadline = 0;
+    long long age_ms = 0;  // Since arrival, so latency figures survive the move
+};
+
+// One line of a node's process list
+struct NodeProcess {
+    std::string name;
+    int core = 0;
+    int current_step = 0;
+    int total_instructions = 0;
+    std::string state;     // running, ready or waiting
+};
+
+// Implemented by the scheduler; called from the node and coordinator threads
+class ClusterHost {
+public:
+    virtual ~ClusterHost() = default;
+    virtual NodeStatus clusterStatus() = 0;
+    virtual std::vector<NodeProcess> clusterProcesses() = 0;
+    virtual bool adoptProcess(const MigratedProcess& process) = 0;
+    // Gives up to count queued processes, which leave this node
+    virtual void releaseQueued(size_t count, std::vector<MigratedProcess>& out) = 0;
+};
+
+// Serves this instance's node on a Unix domain socket
+class ClusterNode {
+public:
+    ClusterNode() {}
+    ~ClusterNode();
+
+    bool start(const std::string& path, ClusterHost* host);
+    void stop();
+    bool running() const { return active.load(); }
+
+private:
+    ClusterNode(const ClusterNode&);
+    ClusterNode& operator=(const ClusterNode&);
+
+    void loop();
+    void serve(int connection);
+
+    std::string path;
+    ClusterHost* host = nullptr;
+    int listener = -1;
+    std::atomic<bool> active{false};
+    std::thread worker;
+};
+
+// Talks to the nodes in cluster-peers on behalf of the local one
+class ClusterCoordinator {
+public:
+    ClusterCoordinator() {}
+    ~ClusterCoordinator();
+
+    void start(ClusterHost* host, const std::vector<std::string>& peers, int balance_ms, double imbalance);
+    void stop();
+    bool running() const { return active.load(); }
+
+    // Node for a new process: -1 for this one, otherwise an index into the peers. Free memory
+    // and load come from the last poll, adjusted for what has been placed since.
+    int choosePlacement(int memory);
+    // Sends a process to a peer; false if the peer could not take it
+    bool sendTo(int peer, const MigratedProcess& process);
+
+    // Cluster sections printed after the local screen -ls and vmstat
+    void writeScreenList(std::ostream& out);
+    void writeVmstat(std::ostream& out);
+    void writeStatus(std::ostream& out);
+
+private:
+    ClusterCoordinator(const ClusterCoordinator&);
+    ClusterCoordinator& operator=(const ClusterCoordinator&);
+
+    struct Peer {
+        std::string path;
+        bool reachable = false;
+        NodeStatus status;     // As of the last poll
+    };
+
+    void loop();
+    void poll();
+    void balance();
+    bool queryStatus(const std::string& path, NodeStatus& status) const;
+    size_t gatherStatus(std::vector<NodeStatus>& nodes, std::vector<int>& peer_of);
+
+    ClusterHost* host = nullptr;
+    std::vector<Peer> peers;   // Guarded by mtx
+    int balance_ms = 1000;
+    double imbalance = 2.0;
+    long long migrations = 0;
+    long long placements = 0;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::atomic<bool> active{false};
+    std::thread worker;
+};
+
+// "a/process3" style name for a process leaving node; unchanged if it already has one
+std::string clusterName(const std::string& node, const std::string& name);
+
+// Node name from its socket path: "/tmp/csopesy-a.sock" -> "csopesy-a"
+std::string nodeNameFromPath(const std::string& path);
+
+#endif // CLUSTER_MANAGER_H
@@ -1,54 +1,461 @@
 #include "configManager.h"
 #include <fstream>
 #include <sstream>
-#include <iostream>
 #include <string>
+#include <algorithm>
+#include <sys/stat.h>
 
-bool ConfigManager::loadConfig(const std::string& filename) {
+bool ConfigManager::parseFile(const std::string& filename, Values& values) {
     std::ifstream configFile(filename);
     if (!configFile.is_open()) {
-        std::cerr << "Error: Could not open config file: " << filename << std::endl;
         return false;
     }
 
     std::string key;
     while (configFile >> key) {
-        if (key == "num-cpu") configFile >> numCPUs;
-        else if (key == "scheduler") configFile >> schedulerType;
-        else if (key == "quantum-cycles") configFile >> quantumCycles;
-        else if (key == "batch-process-freq") configFile >> batchProcessFreq;
-        else if (key == "min-ins") configFile >> minInstructions;
-        else if (key == "max-ins") configFile >> maxInstructions;
-        else if (key == "delay-per-exec") configFile >> delayPerExec;
+        if (key == "num-cpu") configFile >> values.numCPUs;
+        else if (key == "scheduler") {
+            configFile >> values.schedulerType;
+            // Accept both scheduler rr and scheduler "rr"
+            values.schedulerType.erase(std::remove(values.schedulerType.begin(), values.schedulerType.end(), '"'),
+                                       values.schedulerType.end());
+        }
+        else if (key == "quantum-cycles") configFile >> values.quantumCycles;
+        else if (key == "batch-process-freq") configFile >> values.batchProcessFreq;
+        else if (key == "min-ins") configFile >> values.minInstructions;
+        else if (key == "max-ins") configFile >> values.maxInstructions;
+        else if (key == "delay-per-exec" || key == "delays-per-exec") configFile >> values.delayPerExec;
+        else if (key == "max-overall-mem") configFile >> values.maxOverallMemory;
+        else if (key == "mem-per-frame") configFile >> values.memPerFrame;
+        else if (key == "min-mem-per-proc") configFile >> values.minMemPerProc;
+        else if (key == "max-mem-per-proc") configFile >> values.maxMemPerProc;
+        else if (key == "paging") configFile >> values.paging;
+        else if (key == "config-watch") configFile >> values.watch;
+        else if (key == "pin-cores") configFile >> values.pinCores;
+        else if (key == "pin-cpu-offset") configFile >> values.pinCpuOffset;
+        else if (key == "mlfq-levels") configFile >> values.mlfqLevels;
+        else if (key == "mlfq-boost-period") configFile >> values.mlfqBoostPeriod;
+        else if (key == "priority-aging-ticks") configFile >> values.priorityAgingTicks;
+        else if (key == "rt-utilization-cap") configFile >> values.rtUtilizationCap;
+        else if (key == "cluster-socket") {
+            configFile >> values.clusterSocket;
+            values.clusterSocket.erase(std::remove(values.clusterSocket.begin(), values.clusterSocket.end(), '"'),
+                                       values.clusterSocket.end());
+        }
+        else if (key == "cluster-peers") {
+            std::string list;
+            configFile >> list;
+            list.erase(std::remove(list.begin(), list.end(), '"'), list.end());
+            std::replace(list.begin(), list.end(), ',', ' ');
+            std::istringstream peers(list);
+            values.clusterPeers.clear();
+            std::string peer;
+            while (peers >> peer) values.clusterPeers.push_back(peer);
+        }
+        else if (key == "cluster-balance-ms") configFile >> values.clusterBalanceMs;
+        else if (key == "cluster-imbalance") configFile >> values.clusterImbalance;
+        else if (key == "output-ring-lines") configFile >> values.outputRingLines;
+        else if (key == "output-flush") {
+            std::string flush;
+            configFile >> flush;
+            flush.erase(std::remove(flush.begin(), flush.end(), '"'), flush.end());
+            parseOutputFlush(flush, values.outputFlush);
+        }
+        else if (key == "output-flush-batch") configFile >> values.outputFlushBatch;
+        else if (key == "context-switch-ticks") configFile >> values.contextSwitchTicks;
+        else if (key == "migration-ticks") configFile >> values.migrationTicks;
+        else if (key == "cache-reload-ticks") configFile >> values.cacheReloadTicks;
+        else if (key == "cache-warm-ticks") configFile >> values.cacheWarmTicks;
+        else if (key == "steal") configFile >> values.steal;
+        else if (key == "steal-min-queue") configFile >> values.stealMinQueue;
+        else if (key == "admission-max-bypass") configFile >> values.admissionMaxBypass;
+        else if (key == "swap-out") configFile >> values.swapOut;
+        else if (key == "swap-min-idle") configFile >> values.swapMinIdle;
+        else if (key == "ws-window") configFile >> values.workingSetWindow;
+        else if (key == "page-fault-ticks") configFile >> values.pageFaultTicks;
+        else if (key == "thrash-fault-rate") configFile >> values.thrashFaultRate;
+        else if (key == "tlb-entries") configFile >> values.tlbEntries;
+        else if (key == "tlb-ways") configFile >> values.tlbWays;
+        else if (key == "tlb-asid") configFile >> values.tlbAsid;
+        else if (key == "tlb-miss-ticks") configFile >> values.tlbMissTicks;
+        else if (key == "huge-frame-size") configFile >> values.hugeFrameSize;
+        else if (key == "huge-frame-threshold") configFile >> values.hugeFrameThreshold;
+        else if (key == "huge-promote") configFile >> values.hugePromote;
+        else if (key == "share-fraction") configFile >> values.shareFraction;
+        else if (key == "write-ratio") configFile >> values.writeRatio;
+        else if (key == "cow-fault-ticks") configFile >> values.cowFaultTicks;
+        else if (key == "zswap-pool-size") configFile >> values.zswapPoolSize;
+        else if (key == "zswap-load-ticks") configFile >> values.zswapLoadTicks;
+        else if (key == "async-swap") configFile >> values.asyncSwap;
+        else if (key == "swap-prefetch") configFile >> values.swapPrefetch;
+        else if (key == "metrics-file") {
+            configFile >> values.metricsFile;
+            values.metricsFile.erase(std::remove(values.metricsFile.begin(), values.metricsFile.end(), '"'),
+                                     values.metricsFile.end());
+        }
+        else if (key == "metrics-interval-ms") configFile >> values.metricsIntervalMs;
+        else if (key == "report-max-bytes") configFile >> values.reportMaxBytes;
+        else if (key == "report-keep-files") configFile >> values.reportKeepFiles;
+        else if (key == "mlfq-quanta") {
+            std::string list;
+            configFile >> list;
+            std::replace(list.begin(), list.end(), ',', ' ');
+            std::istringstream quanta(list);
+            values.mlfqQuanta.clear();
+            int quantum;
+            while (quanta >> quantum) values.mlfqQuanta.push_back(quantum);
+        }
+        else if (!values.quantumTuning.readConfigKey(key, configFile)) {
+            values.workload.readConfigKey(key, configFile);
+        }
     }
     configFile.close();
     return true;
 }
 
+time_t ConfigManager::modificationTime(const std::string& filename) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) {
+        return 0;
+    }
+    return info.st_mtime;
+}
+
+bool ConfigManager::loadConfig(const std::string& filename, std::string& error) {
+    Values parsed;
+    time_t modTime = modificationTime(filename);
+    if (!parseFile(filename, parsed)) {
+        error = "Could not open config file: " + filename;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    values = parsed;
+    this->filename = filename;
+    loadedModTime = modTime;
+    loaded = true;
+    return true;
+}
+
+bool ConfigManager::reload(std::string& error) {
+    std::string current;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        current = filename;
+    }
+    return loadConfig(current.empty() ? "config.txt" : current, error);
+}
+
+bool ConfigManager::reloadIfChanged(std::string& error) {
+    std::string current;
+    time_t lastModTime;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        current = filename;
+        lastModTime = loadedModTime;
+    }
+    if (current.empty() || modificationTime(current) == lastModTime) {
+        return false;
+    }
+    return loadConfig(current, error);
+}
+
+bool ConfigManager::isLoaded() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return loaded;
+}
+
 int ConfigManager::getNumCPUs() const {
-    return numCPUs;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.numCPUs;
 }
 
 std::string ConfigManager::getSchedulerType() const {
-    return schedulerType;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.schedulerType;
 }
 
 int ConfigManager::getQuantumCycles() const {
-    return quantumCycles;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.quantumCycles;
 }
 
 int ConfigManager::getBatchProcessFreq() const {
-    return batchProcessFreq;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.batchProcessFreq;
 }
 
 int ConfigManager::getMinInstructions() const {
-    return minInstructions;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.minInstructions;
 }
 
 int ConfigManager::getMaxInstructions() const {
-    return maxInstructions;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.maxInstructions;
 }
 
 int ConfigManager::getDelayPerExec() const {
-    return delayPerExec;
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.delayPerExec;
+}
+
+int ConfigManager::getMaxOverallMemory() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.maxOverallMemory;
+}
+
+int ConfigManager::getMemPerFrame() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.memPerFrame;
+}
+
+int ConfigManager::getMinMemPerProc() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.minMemPerProc;
+}
+
+int ConfigManager::getMaxMemPerProc() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.maxMemPerProc;
+}
+
+bool ConfigManager::usePaging() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.paging;
+}
+
+bool ConfigManager::watchEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.watch;
+}
+
+bool ConfigManager::pinCores() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.pinCores;
+}
+
+int ConfigManager::getPinCpuOffset() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.pinCpuOffset;
+}
+
+int ConfigManager::getMlfqLevels() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.mlfqLevels;
+}
+
+std::vector<int> ConfigManager::getMlfqQuanta() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.mlfqQuanta;
+}
+
+int ConfigManager::getMlfqBoostPeriod() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.mlfqBoostPeriod;
+}
+
+int ConfigManager::getPriorityAgingTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.priorityAgingTicks;
+}
+
+double ConfigManager::getRtUtilizationCap() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.rtUtilizationCap;
+}
+
+std::string ConfigManager::getClusterSocket() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.clusterSocket;
+}
+
+std::vector<std::string> ConfigManager::getClusterPeers() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.clusterPeers;
+}
+
+int ConfigManager::getClusterBalanceMs() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.clusterBalanceMs;
+}
+
+double ConfigManager::getClusterImbalance() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.clusterImbalance;
+}
+
+int ConfigManager::getOutputRingLines() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.outputRingLines;
+}
+
+OutputFlush ConfigManager::getOutputFlush() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.outputFlush;
+}
+
+int ConfigManager::getOutputFlushBatch() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.outputFlushBatch;
+}
+
+int ConfigManager::getContextSwitchTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.contextSwitchTicks;
+}
+
+int ConfigManager::getMigrationTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.migrationTicks;
+}
+
+int ConfigManager::getCacheReloadTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.cacheReloadTicks;
+}
+
+int ConfigManager::getCacheWarmTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.cacheWarmTicks;
+}
+
+bool ConfigManager::stealEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.steal;
+}
+
+int ConfigManager::getStealMinQueue() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.stealMinQueue;
+}
+
+int ConfigManager::getAdmissionMaxBypass() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.admissionMaxBypass;
+}
+
+bool ConfigManager::swapOutEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.swapOut;
+}
+
+int ConfigManager::getSwapMinIdle() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.swapMinIdle;
+}
+
+int ConfigManager::getWorkingSetWindow() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.workingSetWindow;
+}
+
+int ConfigManager::getPageFaultTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.pageFaultTicks;
+}
+
+double ConfigManager::getThrashFaultRate() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.thrashFaultRate;
+}
+
+int ConfigManager::getTlbEntries() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.tlbEntries;
+}
+
+int ConfigManager::getTlbWays() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.tlbWays;
+}
+
+bool ConfigManager::tlbAsidTagged() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.tlbAsid;
+}
+
+int ConfigManager::getTlbMissTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.tlbMissTicks;
+}
+
+int ConfigManager::getHugeFrameSize() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.hugeFrameSize;
+}
+
+int ConfigManager::getHugeFrameThreshold() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.hugeFrameThreshold;
+}
+
+bool ConfigManager::hugePromote() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.hugePromote;
+}
+
+double ConfigManager::getShareFraction() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.shareFraction;
+}
+
+double ConfigManager::getWriteRatio() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.writeRatio;
+}
+
+int ConfigManager::getCowFaultTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.cowFaultTicks;
+}
+
+int ConfigManager::getZswapPoolSize() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.zswapPoolSize;
+}
+
+int ConfigManager::getZswapLoadTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.zswapLoadTicks;
+}
+
+bool ConfigManager::asyncSwap() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.asyncSwap;
+}
+
+int ConfigManager::getSwapPrefetch() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.swapPrefetch;
+}
+
+std::string ConfigManager::getMetricsFile() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.metricsFile;
+}
+
+int ConfigManager::getMetricsIntervalMs() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.metricsIntervalMs;
+}
+
+int ConfigManager::getReportMaxBytes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.reportMaxBytes;
+}
+
+int ConfigManager::getReportKeepFiles() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.reportKeepFiles;
+}
+
+WorkloadSettings ConfigManager::getWorkloadSettings() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.workload;
+}
+
+QuantumTuning ConfigManager::getQuantumTuning() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return values.quantumTuning;
 }
@@ -1,11 +1,23 @@
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 
-#include <string> 
+#include <string>
+#include <mutex>
+#include <ctime>
+#include <vector>
+#include "workloadGenerator.h"
+#include "quantumController.h"
+#include "outputRing.h"
 
+// Single source of truth for config.txt; safe to reload while the scheduler is running
 class ConfigManager {
 public:
-    bool loadConfig(const std::string& filename); 
+    // On failure error says why; nothing is printed, so the caller decides where it goes
+    bool loadConfig(const std::string& filename, std::string& error);
+    bool reload(std::string& error);          // Re-reads the last loaded file
+    bool reloadIfChanged(std::string& error); // Reloads only if the file was modified since the last load
+    bool isLoaded() const;
+
     std::string getSchedulerType() const;
     int getNumCPUs() const;
     int getQuantumCycles() const;
@@ -13,15 +25,130 @@ public:
     int getMinInstructions() const;
     int getMaxInstructions() const;
     int getDelayPerExec() const;
+    int getMaxOverallMemory() const;
+    int getMemPerFrame() const;
+    int getMinMemPerProc() const;
+    int getMaxMemPerProc() const;
+    bool usePaging() const;
+    bool watchEnabled() const;
+    bool pinCores() const;
+    int getPinCpuOffset() const;
+    int getMlfqLevels() const;
+    std::vector<int> getMlfqQuanta() const;
+    int getMlfqBoostPeriod() const;
+    int getPriorityAgingTicks() const;
+    double getRtUtilizationCap() const;
+    std::string getClusterSocket() const;
+    std::vector<std::string> getClusterPeers() const;
+    int getClusterBalanceMs() const;
+    double getClusterImbalance() const;
+    int getOutputRingLines() const;
+    OutputFlush getOutputFlush() const;
+    int getOutputFlushBatch() const;
+    int getContextSwitchTicks() const;
+    int getMigrationTicks() const;
+    int getCacheReloadTicks() const;
+    int getCacheWarmTicks() const;
+    bool stealEnabled() const;
+    int getStealMinQueue() const;
+    int getAdmissionMaxBypass() const;
+    bool swapOutEnabled() const;
+    int getSwapMinIdle() const;
+    int getWorkingSetWindow() const;
+    int getPageFaultTicks() const;
+    double getThrashFaultRate() const;
+    int getTlbEntries() const;
+    int getTlbWays() const;
+    bool tlbAsidTagged() const;
+    int getTlbMissTicks() const;
+    int getHugeFrameSize() const;
+    int getHugeFrameThreshold() const;
+    bool hugePromote() const;
+    double getShareFraction() const;
+    double getWriteRatio() const;
+    int getCowFaultTicks() const;
+    int getZswapPoolSize() const;
+    int getZswapLoadTicks() const;
+    bool asyncSwap() const;
+    int getSwapPrefetch() const;
+    std::string getMetricsFile() const;
+    int getMetricsIntervalMs() const;
+    int getReportMaxBytes() const;
+    int getReportKeepFiles() const;
+    WorkloadSettings getWorkloadSettings() const;
+    QuantumTuning getQuantumTuning() const;
 
 private:
-    std::string schedulerType;
-    int numCPUs;
-    int quantumCycles;
-    int batchProcessFreq;
-    int minInstructions;
-    int maxInstructions;
-    int delayPerExec;
+    struct Values {
+        std::string schedulerType = "rr";
+        int numCPUs = 4;
+        int quantumCycles = 5;
+        int batchProcessFreq = 1;
+        int minInstructions = 1000;
+        int maxInstructions = 2000;
+        int delayPerExec = 0;
+        int maxOverallMemory = 16384;
+        int memPerFrame = 4096;
+        int minMemPerProc = 0;
+        int maxMemPerProc = 0;
+        bool paging = false;
+        bool watch = false;
+        bool pinCores = false;       // Pin each core worker to one host CPU
+        int pinCpuOffset = 0;        // Index into the allowed host CPUs for core 0
+        int mlfqLevels = 3;
+        std::vector<int> mlfqQuanta; // Per-level quanta, e.g. 2,4,8; empty doubles quantum-cycles per level
+        int mlfqBoostPeriod = 50;    // Ticks between priority boosts; 0 disables boosting
+        int priorityAgingTicks = 20; // Ticks of waiting that raise a process one priority level; 0 disables aging
+        double rtUtilizationCap = 0.7; // Share of each core the EDF class may reserve; the rest stays with RR work
+        std::string clusterSocket;   // Unix socket this instance serves its cluster node on; empty runs standalone
+        std::vector<std::string> clusterPeers; // Other nodes' sockets; set only on the coordinator
+        int clusterBalanceMs = 1000; // How often the coordinator polls the nodes and rebalances
+        double clusterImbalance = 2.0; // Difference in processes per core that triggers a migration
+        int outputRingLines = 100;   // Recent output lines kept in memory per screen process
+        OutputFlush outputFlush = OutputFlush::Off; // When that output is also written to <name>.txt
+        int outputFlushBatch = 256;  // Lines per write with output-flush batch, at most outputRingLines
+        int contextSwitchTicks = 0;  // Ticks lost when a core switches to a different process
+        int migrationTicks = 0;      // Extra ticks when a process runs on a different core than last time
+        int cacheReloadTicks = 0;    // Ticks to rewarm a cold cache
+        int cacheWarmTicks = 20;     // A core's cache stays warm for a process this many ticks of other work
+        bool steal = true;           // Idle cores take work from busy cores' queues
+        int stealMinQueue = 2;       // Only steal from queues at least this long
+        int admissionMaxBypass = 8;  // Smaller processes that may backfill past a blocked one
+        bool swapOut = true;         // Swap out idle residents when a blocked process has waited long enough
+        int swapMinIdle = 10;        // Ticks a resident must sit idle before it can be swapped out
+        int workingSetWindow = 4;    // Quanta a page stays in the working set after its last use (1-8)
+        int pageFaultTicks = 1;      // Ticks a faulting instruction stalls while its page loads
+        double thrashFaultRate = 20; // Faults per 100 references above which working sets are enforced
+        int tlbEntries = 0;          // Per-core TLB entries; 0 disables the TLB model
+        int tlbWays = 4;             // Associativity
+        bool tlbAsid = true;         // ASID-tagged entries survive context switches; 0 flushes on every switch
+        int tlbMissTicks = 1;        // Page-walk stall on a TLB miss
+        int hugeFrameSize = 0;       // Second, larger frame size; 0 disables huge frames
+        int hugeFrameThreshold = 0;  // Smallest process that gets huge frames; 0 means one huge frame
+        bool hugePromote = true;     // Move small frames into huge frames once whole blocks free up
+        double shareFraction = 0.5;  // Share of a program's pages mapped from its shared image
+        double writeRatio = 0.3;     // Share of memory references that are writes
+        int cowFaultTicks = 1;       // Stall while a shared page is copied on first write
+        int zswapPoolSize = 0;       // Bytes of memory set aside to hold swapped pages compressed; 0 disables
+        int zswapLoadTicks = 0;      // Stall while a faulting page is decompressed from the pool
+        bool asyncSwap = true;       // Page-ins block only the faulting process; a swap I/O thread does the transfers
+        int swapPrefetch = 2;        // Pages read ahead for the next process in each core's queue; 0 disables
+        std::string metricsFile;     // Prometheus text file rewritten while the scheduler runs; empty disables
+        int metricsIntervalMs = 1000;
+        int reportMaxBytes = 8388608; // Report files past this size are rotated before the next report; 0 never rotates
+        int reportKeepFiles = 3;     // Rotated copies kept: csopesy-log.txt.1, .2, ...
+        WorkloadSettings workload;
+        QuantumTuning quantumTuning;
+    };
+
+    static bool parseFile(const std::string& filename, Values& values);
+    static time_t modificationTime(const std::string& filename);
+
+    mutable std::mutex mtx;
+    Values values;
+    std::string filename;
+    time_t loadedModTime = 0;
+    bool loaded = false;
 };
 
 #endif // CONFIG_MANAGER_H
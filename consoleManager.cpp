@@ -13,6 +13,7 @@
 #include <sstream>
 #include <fstream>
 #include <sys/stat.h> 
+#include <memory>
 #include <mutex>
 
 std::mutex processMutex;
@@ -73,56 +74,65 @@ int consoleManager::validateCommand(const std::string& command) {
 }
 
 void consoleManager::loadConfig() {
-    std::ifstream configFile("config.txt");
-    if (configFile.is_open()) {
-        std::string key;
-        while (configFile >> key) {
-            if (key == "num-cpu") configFile >> numCPUs;
-            else if (key == "scheduler") configFile >> schedulerType;
-            else if (key == "quantum-cycles") configFile >> quantumCycles;
-            else if (key == "batch-process-freq") configFile >> batchProcessFreq;
-            else if (key == "min-ins") configFile >> minInstructions;
-            else if (key == "max-ins") configFile >> maxInstructions;
-            else if (key == "delay-per-exec") configFile >> delayPerExec;
-        }
-        configFile.close();
+    std::string error;
+    if (config.loadConfig("config.txt", error)) {
+        numCPUs = config.getNumCPUs();
+        schedulerType = config.getSchedulerType();
+        quantumCycles = config.getQuantumCycles();
+        batchProcessFreq = config.getBatchProcessFreq();
+        minInstructions = config.getMinInstructions();
+        maxInstructions = config.getMaxInstructions();
+        delayPerExec = config.getDelayPerExec();
+        reportWriter.setRotation(config.getReportMaxBytes(), config.getReportKeepFiles());
+        outputRingLines = config.getOutputRingLines();
+        outputFlush = config.getOutputFlush();
+        outputFlushBatch = config.getOutputFlushBatch();
         std::cout << "Config loaded successfully.\n";
     } else {
-        std::cout << "Error: Could not open config.txt. Using default values.\n";
+        std::cout << "Error: " << error << ". Using default values.\n";
     }
 }
 
+// Only the process lists are copied here; the rows are streamed into the file on the
+// report writer's thread
 void consoleManager::generateProcessReport(const std::string& filename) {
-    std::ostringstream reportContent;
-    reportContent << "root:> report-util\n";
-    reportContent << "CPU utilization: 100%\n";
-    reportContent << "Cores used: " << runningProcesses.size() << "\n";
-    reportContent << "Cores available: " << (numCPUs - runningProcesses.size()) << "\n";
-    reportContent << "------------------------------------------------------------\n\n";
-
-    reportContent << "Running processes:\n";
-    for (const auto& process : runningProcesses) {
-        reportContent << process->getProcessName() << "  (" << getCurrentTimeString() << ")  ";
-        reportContent << "Core: " << process->getCoreId() << "   ";
-        reportContent << process->getProgress() << " / " << process->getTotalWork() << "\n";
-    }
-
-    reportContent << "\nFinished processes:\n";
-    for (const auto& process : finishedProcesses) {
-        reportContent << process->getProcessName() << "  (" << getCurrentTimeString() << ")  ";
-        reportContent << "Finished   " << process->getTotalWork() << " / " << process->getTotalWork() << "\n";
+    std::shared_ptr<std::vector<Process*>> running = std::make_shared<std::vector<Process*>>();
+    std::shared_ptr<std::vector<Process*>> finished = std::make_shared<std::vector<Process*>>();
+    {
+        std::lock_guard<std::mutex> lock(processMutex);
+        running->assign(runningProcesses.begin(), runningProcesses.end());
+        *finished = finishedProcesses;
     }
-    reportContent << "------------------------------------------------------------\n";
+    int cpus = numCPUs;
+
+    bool queued = reportWriter.submit(filename, [running, finished, cpus](std::ostream& reportFile) {
+        std::string now = getCurrentTimeString();
+        reportFile << "root:> report-util\n";
+        reportFile << "CPU utilization: 100%\n";
+        reportFile << "Cores used: " << running->size() << "\n";
+        reportFile << "Cores available: " << (cpus - static_cast<int>(running->size())) << "\n";
+        reportFile << "------------------------------------------------------------\n\n";
+
+        reportFile << "Running processes:\n";
+        for (const auto& process : *running) {
+            reportFile << process->getProcessName() << "  (" << now << ")  ";
+            reportFile << "Core: " << process->getCoreId() << "   ";
+            reportFile << process->getProgress() << " / " << process->getTotalWork() << "\n";
+        }
 
-    std::cout << reportContent.str();
+        reportFile << "\nFinished processes:\n";
+        for (const auto& process : *finished) {
+            reportFile << process->getProcessName() << "  (" << now << ")  ";
+            reportFile << "Finished   " << process->getTotalWork() << " / " << process->getTotalWork() << "\n";
+        }
+        reportFile << "------------------------------------------------------------\n";
+        return running->size() + finished->size();
+    });
 
-    std::ofstream reportFile(filename, std::ios::app);
-    if (reportFile.is_open()) {
-        reportFile << reportContent.str();
-        reportFile.close();
-        std::cout << "root:> Report saved to " << filename << "\n";
+    if (queued) {
+        std::cout << "root:> Writing report to " << filename << " in the background.\n";
     } else {
-        std::cerr << "Error: Could not open or create file " << filename << ".\n";
+        std::cerr << "Error: Too many reports are queued; try again once one has been saved.\n";
     }
 }
 
@@ -181,39 +191,100 @@ void consoleManager::startProcessScreen(const std::string& processName) {
     // Create a new process with the specified name and total lines
     Process* newProcess = new Process(processCount - 1, totalLines);  // Use processCount - 1 for ID consistency
     newProcess->processName = processName;
+    newProcess->output.configure(outputRingLines, outputFlush, outputFlushBatch);
+    if (outputFlush != OutputFlush::Off) {
+        std::remove((processName + ".txt").c_str()); // Batches are appended; start from an empty file
+    }
 
     // Lock and add to running processes
     {
         std::lock_guard<std::mutex> lock(processMutex);
         runningProcesses.push_back(newProcess);
     }
+    processIndex.insert(newProcess->getId(), processName, newProcess);
 
-    std::string filename = processName + ".txt";
-    std::ofstream processFile(filename);
-
-    // Launch the logging process in a detached thread to run in the background
-    std::thread([this, newProcess, filename, totalLines](std::ofstream processFile) mutable {
-        if (processFile.is_open()) {
-            for (int i = 0; i < totalLines; ++i) {
-                auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-                processFile << "Welcome to CSOPESY command line! " << std::ctime(&now);
-                newProcess->incrementProgress();
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            }
-            processFile.close();
+    // Run the process in the background; the destructor joins it
+    {
+        std::lock_guard<std::mutex> lock(processMutex);
+        outputThreads.emplace_back(&consoleManager::runProcessOutput, this, newProcess);
+    }
+
+    // Clear the screen and display the new process prompt
+    clearScreen();
+    processScreenPrompt(newProcess);
+}
+
+// Runs a screen process to the end, or until the console closes. Each PRINT goes into the
+// process's output ring; file writes, when output-flush asks for them, happen in batches on
+// the output writer's thread.
+void consoleManager::runProcessOutput(Process* process) {
+    while (!process->isFinished() && !shuttingDown.load()) {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::string line = std::string("Welcome to CSOPESY command line! ") + std::ctime(&now);
+        line.erase(line.size() - 1); // ctime ends with a newline
+        if (process->output.append(line)) {
+            flushOutput(process, false);
         }
+        process->incrementProgress();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    flushOutput(process, true);
 
-        // Move process to finished processes once it completes
-        {
-            std::lock_guard<std::mutex> lock(processMutex);
-            runningProcesses.erase(std::remove(runningProcesses.begin(), runningProcesses.end(), newProcess), runningProcesses.end());
-            finishedProcesses.push_back(newProcess);
+    // Move process to finished processes once it completes
+    {
+        std::lock_guard<std::mutex> lock(processMutex);
+        runningProcesses.erase(std::remove(runningProcesses.begin(), runningProcesses.end(), process), runningProcesses.end());
+        finishedProcesses.push_back(process);
+    }
+}
+
+// Hands a batch (or, when final, everything left) to the output writer. A batch the writer
+// cannot queue yet goes back to the ring and is retried with the next one; the final flush
+// waits for room, but gives up once the writer has stopped.
+void consoleManager::flushOutput(Process* process, bool final) {
+    std::shared_ptr<std::vector<std::string>> lines = std::make_shared<std::vector<std::string>>();
+    while (process->output.takeBatch(*lines, final)) {
+        bool queued = outputWriter.submit(process->getProcessName() + ".txt", [lines](std::ostream& processFile) {
+            for (const auto& line : *lines) {
+                processFile << line << "\n";
+            }
+            return lines->size();
+        }, false);
+        if (queued) {
+            lines = std::make_shared<std::vector<std::string>>();
+            continue;
         }
-    }, std::move(processFile)).detach();
+        process->output.returnBatch(lines->size());
+        if (!final || outputWriter.stopped()) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // The last batch must not be lost
+    }
+}
 
-    // Clear the screen and display the new process prompt
-    clearScreen();
-    std::cout << "Process " << newProcess->processName << ":> ";
+// The last lines a process printed, straight from its ring
+void consoleManager::printRecentOutput(Process* process, size_t lines) {
+    std::vector<std::string> recent = process->output.recent(lines);
+    for (const auto& line : recent) {
+        std::cout << line << "\n";
+    }
+}
+
+void consoleManager::printProcessInfo(Process* process) {
+    std::cout << "Process: " << process->getProcessName() << "\n";
+    std::cout << "ID: " << process->getId() << "\n";
+    std::cout << "Current instruction line: " << process->getProgress() << "\n";
+    std::cout << "Lines of code: " << process->getTotalWork() << "\n";
+    if (process->output.total() > 0) {
+        std::cout << "Recent output:\n";
+        printRecentOutput(process, kSmiOutputLines);
+    }
+    if (process->isFinished()) {
+        std::cout << "Finished!\n";
+    }
+}
+
+// The attached screen shared by screen -s and screen -r
+void consoleManager::processScreenPrompt(Process* process) {
+    std::cout << "Process " << process->getProcessName() << ":> ";
 
     std::string userCommand;
     while (true) {
@@ -221,14 +292,11 @@ void consoleManager::startProcessScreen(const std::string& processName) {
         if (userCommand == "exit") {
             break;
         } else if (userCommand == "process-smi") {
-            std::cout << "Process: " << newProcess->getProcessName() << "\n";
-            std::cout << "ID: " << newProcess->getId() << "\n";  // Display the process ID
-            std::cout << "Current instruction line: " << newProcess->getProgress() << "\n";
-            std::cout << "Lines of code: " << newProcess->getTotalWork() << "\n";
-            std::cout << "Process " << newProcess->processName << ":> ";
+            printProcessInfo(process);
+            std::cout << "Process " << process->getProcessName() << ":> ";
         } else {
             std::cout << "Invalid command. Type 'process-smi' to view status or 'exit' to go back to the main menu.\n";
-            std::cout << "Process " << newProcess->processName << ":> ";
+            std::cout << "Process " << process->getProcessName() << ":> ";
         }
     }
 }
@@ -237,66 +305,18 @@ void consoleManager::startProcessScreen(const std::string& processName) {
 // used for screen -r <process name> command 
 void consoleManager::reattachProcessScreen(const std::string& processName) {
     Process* targetProcess = nullptr;
+    processIndex.findByName(processName, targetProcess);
 
-    // Search for the process in the runningProcesses
-    {
-        std::lock_guard<std::mutex> lock(processMutex);
-        for (auto process : runningProcesses) {
-            if (process->getProcessName() == processName && !process->isFinished()) {
-                targetProcess = process;
-                break;
-            }
-        }
-    }
-
-    if (targetProcess) {
+    if (targetProcess && targetProcess->isFinished()) {
+        std::cout << "screen '" << processName << "' has finished.\n";
+    } else if (targetProcess) {
         clearScreen();
         std::cout << "Reattaching to process: " << processName << "\n";
-        std::cout << "Process " << targetProcess->getProcessName() << ":> ";
-
-        int remainingLines = targetProcess->getTotalWork() - targetProcess->getProgress();
-        std::string filename = targetProcess->getProcessName() + ".txt";
-        std::ofstream processFile(filename, std::ios::app); // Open in append mode to continue logging
-
-        // Relaunch the logging in a detached thread to continue printing the remaining lines
-        std::thread([this, targetProcess, filename, remainingLines](std::ofstream processFile) mutable {
-            if (processFile.is_open()) {
-                for (int i = 0; i < remainingLines; ++i) {
-                    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-                    processFile << "Welcome to CSOPESY command line! " << std::ctime(&now);
-                    targetProcess->incrementProgress();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                }
-                processFile.close();
-            }
-
-            // Move process to finished processes once it completes
-            {
-                std::lock_guard<std::mutex> lock(processMutex);
-                runningProcesses.erase(std::remove(runningProcesses.begin(), runningProcesses.end(), targetProcess), runningProcesses.end());
-                finishedProcesses.push_back(targetProcess);
-            }
-        }, std::move(processFile)).detach();
-
-        // Display process prompt and handle user input
-        std::string userCommand;
-        while (true) {
-            std::getline(std::cin, userCommand);
-            if (userCommand == "exit") {
-                break;
-            } else if (userCommand == "process-smi") {
-                std::cout << "Process: " << targetProcess->getProcessName() << "\n";
-                std::cout << "ID: " << targetProcess->getId() << "\n";
-                std::cout << "Current instruction line: " << targetProcess->getProgress() << "\n";
-                std::cout << "Lines of code: " << targetProcess->getTotalWork() << "\n";
-                std::cout << "Process " << targetProcess->getProcessName() << ":> ";
-            } else {
-                std::cout << "Invalid command. Type 'process-smi' to view status or 'exit' to go back to the main menu.\n";
-                std::cout << "Process " << targetProcess->getProcessName() << ":> ";
-            }
-        }
+        // The process kept running in the background; show where it got to from its ring
+        printRecentOutput(targetProcess, kScreenOutputLines);
+        processScreenPrompt(targetProcess);
     } else {
-        std::cout << "screen '" << processName << "' does not exist or has finished.\n";
+        std::cout << "screen '" << processName << "' does not exist.\n";
     }
 }
 
@@ -309,6 +329,7 @@ void consoleManager::createDummyProcess() {
         std::lock_guard<std::mutex> lock(processMutex);
         runningProcesses.push_back(dummyProcess);
     }
+    processIndex.insert(dummyProcess->getId(), dummyProcess->processName, dummyProcess);
 
     // Background thread for the dummy process execution
     std::thread([this, dummyProcess]() {
@@ -385,7 +406,7 @@ void consoleManager::processGenerator() {
 
 
 // Constructor: initialize thread pool and set stopScheduler to false
-consoleManager::consoleManager() : initializer(), stopScheduler(false) {
+consoleManager::consoleManager() : initializer(), stopScheduler(false), outputWriter(kOutputQueued) {
     int threadCount = std::thread::hardware_concurrency();
     for (int i = 0; i < threadCount; ++i) {
         threadPool.emplace_back(&consoleManager::workerThread, this);
@@ -393,6 +414,18 @@ consoleManager::consoleManager() : initializer(), stopScheduler(false) {
 }
 
 consoleManager::~consoleManager() {
+    // Screen processes flush what they printed before the output writer stops
+    shuttingDown = true;
+    std::vector<std::thread> outputs;
+    {
+        std::lock_guard<std::mutex> lock(processMutex);
+        outputs.swap(outputThreads);
+    }
+    for (std::thread& output : outputs) {
+        output.join();
+    }
+    outputWriter.finish();
+    reportWriter.finish();
     {
         std::lock_guard<std::mutex> lock(queueMutex);
         stopScheduler = true;
@@ -432,14 +465,10 @@ void consoleManager::workerThread() {
 
 
 void consoleManager::handleProcessSmi(const std::string& processName) {
-    for (auto& process : runningProcesses) {
-        if (process->getProcessName() == processName) {
-            std::cout << "Process: " << process->getProcessName() << std::endl;
-            std::cout << "ID: " << process->getId() << std::endl;
-            std::cout << "Current Instruction Line: " << process->getProgress() << std::endl;
-            std::cout << "Lines of Code: " << process->getTotalWork() << std::endl;
-            return;
-        }
+    Process* process = nullptr;
+    if (processIndex.find(processName, process)) {
+        printProcessInfo(process);
+        return;
     }
     std::cout << "Process " << processName << " not found.\n";
 }
@@ -13,6 +13,9 @@
 #include <fstream>
 #include "initializer.h"
 #include "process.h"
+#include "configManager.h"
+#include "processIndex.h"
+#include "reportWriter.h"
 
 class consoleManager {
 public:
@@ -40,9 +43,19 @@ public:
     void workerThread(); // Thread pool worker function
 
 private:
+    static const size_t kScreenOutputLines = 20; // Shown on screen -r
+    static const size_t kSmiOutputLines = 5;     // Shown by process-smi
+    static const size_t kOutputQueued = 64;      // Output batches waiting for their files, all screens together
+
     void startProcessScreen(const std::string& processName);
+    void processScreenPrompt(Process* process);
+    void runProcessOutput(Process* process);
+    void flushOutput(Process* process, bool final);
+    void printRecentOutput(Process* process, size_t lines);
+    void printProcessInfo(Process* process);
 
     // Configuration parameters
+    ConfigManager config;
     int numCPUs = 4;
     std::string schedulerType = "rr"; // Default scheduler set to RR
     int quantumCycles = 5;
@@ -50,23 +63,32 @@ private:
     int minInstructions = 1000;
     int maxInstructions = 2000;
     int delayPerExec = 0;
+    int outputRingLines = 100;
+    OutputFlush outputFlush = OutputFlush::Off;
+    int outputFlushBatch = 256;
 
     // Process management variables
     Initializer initializer;
     std::vector<Process*> finishedProcesses;
     std::deque<Process*> runningProcesses; // Changed to deque for RR scheduling
+    ProcessIndex<Process*> processIndex;   // Name/ID lookup over running and finished processes
     std::atomic<bool> stopScheduler;
     bool generatingProcesses = false;
     std::thread processGeneratorThread;
     int processGenerationFrequency = 1;
     int processCount = 1;
     std::mutex processMutex;
+    std::vector<std::thread> outputThreads; // One per screen process; guarded by processMutex
+    std::atomic<bool> shuttingDown{false};  // Ends the screen processes early when the console closes
 
     // Thread pool and task queue for managing background tasks
     std::vector<std::thread> threadPool;
     std::queue<std::function<void()>> taskQueue;
     std::mutex queueMutex;
     std::condition_variable condition;
+
+    ReportWriter reportWriter; // report-util output is written on its own thread
+    ReportWriter outputWriter; // Process output batches, with a queue budget of their own
 };
 
 #endif // CONSOLE_MANAGER_H
@@ -0,0 +1,298 @@
+#include "daemonServer.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+const int kAcceptPollMs = 200;   // How often the accept loop checks for stop
+const int kSendTimeoutMs = 2000; // A client that stops reading for this long is dropped
+const size_t kMaxLineBytes = 4096;
+
+bool fillAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+void noSigpipe(int fd) {
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+    (void)fd;
+#endif
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Moves the first complete line out of buffer; false if there is none yet
+bool takeLine(std::string& buffer, std::string& line) {
+    size_t end = buffer.find('\n');
+    if (end == std::string::npos) return false;
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    return true;
+}
+}
+
+ClientSession::ClientSession(int fd) : fd(fd) {
+    timeval timeout;
+    timeout.tv_sec = kSendTimeoutMs / 1000;
+    timeout.tv_usec = (kSendTimeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    noSigpipe(fd);
+}
+
+ClientSession::Input ClientSession::readLine(std::string& line, int timeout_ms) {
+    while (!takeLine(input, line)) {
+        if (input.size() > kMaxLineBytes) return Input::Closed;
+        pollfd waiting;
+        waiting.fd = fd;
+        waiting.events = POLLIN;
+        waiting.revents = 0;
+        int ready = ::poll(&waiting, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) return Input::Closed;
+        if (ready == 0) return Input::Timeout;
+        char buffer[1024];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return Input::Closed;
+        input.append(buffer, static_cast<size_t>(n));
+    }
+    return Input::Line;
+}
+
+bool ClientSession::send(const std::string& text) {
+    std::string framed;
+    framed.reserve(text.size() + 16);
+    for (char c : text) {
+        if (at_line_start && c == '.') framed += '.';
+        framed += c;
+        at_line_start = c == '\n';
+    }
+    return writeAll(fd, framed);
+}
+
+bool ClientSession::endReply(const std::string& prompt) {
+    std::string end = at_line_start ? "." : "\n.";
+    at_line_start = true;
+    return writeAll(fd, end + prompt + "\n");
+}
+
+DaemonServer::~DaemonServer() {
+    stop();
+    reap(true);
+    if (listener >= 0) {
+        close(listener);
+        unlink(path.c_str());
+    }
+}
+
+bool DaemonServer::listen(const std::string& socket_path) {
+    sockaddr_un address;
+    if (!fillAddress(socket_path, address)) return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    // A socket file left by a daemon that died is removed; a live one still answers
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0) {
+        bool live = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        close(probe);
+        if (live) {
+            close(fd);
+            return false;
+        }
+    }
+    unlink(socket_path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    path = socket_path;
+    listener = fd;
+    return true;
+}
+
+void DaemonServer::serve(Handler handler) {
+    while (!stopping.load()) {
+        reap(false);
+        pollfd waiting;
+        waiting.fd = listener;
+        waiting.events = POLLIN;
+        waiting.revents = 0;
+        if (::poll(&waiting, 1, kAcceptPollMs) <= 0) continue;
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) continue;
+
+        std::unique_ptr<Slot> slot(new Slot());
+        Slot* raw = slot.get();
+        raw->fd = connection;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping.load()) {
+            close(connection);
+            break;
+        }
+        raw->thread = std::thread([raw, handler]() {
+            ClientSession session(raw->fd);
+            handler(session);
+            raw->done.store(true);
+        });
+        slots.push_back(std::move(slot));
+    }
+    reap(true);
+}
+
+void DaemonServer::stop() {
+    stopping.store(true);
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& slot : slots) {
+        shutdown(slot->fd, SHUT_RDWR); // Wakes a session blocked reading its client
+    }
+}
+
+// Joins finished sessions, or with all every session once stop() has disconnected them
+void DaemonServer::reap(bool all) {
+    std::list<std::unique_ptr<Slot>> ended;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto it = slots.begin(); it != slots.end();) {
+            if (all || (*it)->done.load()) {
+                ended.push_back(std::move(*it));
+                it = slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& slot : ended) {
+        if (slot->thread.joinable()) slot->thread.join();
+        close(slot->fd);
+    }
+}
+
+bool detachFromTerminal(const std::string& log_path, const std::string& started) {
+    std::cout.flush();
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child > 0) {
+        std::cout << started << child << "\n";
+        std::cout.flush();
+        _exit(0); // The socket and files belong to the child now
+    }
+    setsid();
+    int null_fd = open("/dev/null", O_RDONLY);
+    int log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (null_fd >= 0) dup2(null_fd, STDIN_FILENO);
+    if (log_fd >= 0) {
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+    }
+    if (null_fd > STDERR_FILENO) close(null_fd);
+    if (log_fd > STDERR_FILENO) close(log_fd);
+    return true;
+}
+
+int runClient(const std::string& path) {
+    sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || !fillAddress(path, address) ||
+        connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Cannot reach a daemon on " << path << "; start one with --daemon.\n";
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    noSigpipe(fd);
+
+    // Piped input is sent one line per reply, so scripts see each command's full output.
+    // Typed input goes straight through, which is how a follow is interrupted.
+    bool interactive = isatty(STDIN_FILENO) != 0;
+    bool awaiting = true;       // The daemon greets with a prompt
+    bool input_done = false;
+    std::string received, typed;
+    std::deque<std::string> queued;
+    while (true) {
+        while (!queued.empty() && (!awaiting || interactive)) {
+            if (!writeAll(fd, queued.front() + "\n")) {
+                close(fd);
+                return 0;
+            }
+            queued.pop_front();
+            awaiting = true;
+        }
+        if (input_done && queued.empty() && !awaiting) break;
+
+        pollfd waiting[2];
+        waiting[0].fd = fd;
+        waiting[0].events = POLLIN;
+        waiting[1].fd = STDIN_FILENO;
+        waiting[1].events = POLLIN;
+        waiting[0].revents = waiting[1].revents = 0;
+        int count = input_done ? 1 : 2;
+        if (::poll(waiting, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        char buffer[4096];
+        if (waiting[0].revents != 0) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break; // Detached, or the daemon shut down
+            received.append(buffer, static_cast<size_t>(n));
+            std::string line;
+            while (takeLine(received, line)) {
+                if (line.compare(0, 2, "..") == 0) {
+                    std::cout << line.substr(1) << "\n";
+                } else if (!line.empty() && line[0] == '.') {
+                    std::cout << line.substr(1);
+                    awaiting = false;
+                } else {
+                    std::cout << line << "\n";
+                }
+            }
+            std::cout.flush();
+        }
+        if (count > 1 && waiting[1].revents != 0) {
+            ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                input_done = true;
+                if (!typed.empty()) queued.push_back(typed);
+                typed.clear();
+                continue;
+            }
+            typed.append(buffer, static_cast<size_t>(n));
+            std::string line;
+            while (takeLine(typed, line)) queued.push_back(line);
+        }
+    }
+    close(fd);
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef DAEMON_SERVER_H
+#define DAEMON_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// CSOPESYApp --daemon runs the emulator in the background with no console of its own, and
+// CSOPESYApp --attach connects a client to it over a Unix domain socket. Each client gets its
+// own session thread, so a slow or idle client only ever holds up itself.
+//
+// The protocol is line based in both directions. The client sends one command line; the
+// daemon answers with any number of output lines and ends the reply with a line holding a
+// single "." followed by the prompt to show. Output lines that start with "." are sent with
+// a second "." in front, as in SMTP.
+
+const char* const kDefaultDaemonSocket = "/tmp/csopesy.sock";
+
+// One attached client, as its session thread sees it
+class ClientSession {
+public:
+    enum class Input { Line, Timeout, Closed };
+
+    explicit ClientSession(int fd);
+
+    // Waits up to timeout_ms (-1 for no limit) for the next command line
+    Input readLine(std::string& line, int timeout_ms);
+
+    // Output belonging to the current reply; false once the client has gone
+    bool send(const std::string& text);
+
+    // Ends the reply; the client shows prompt and sends its next line
+    bool endReply(const std::string& prompt);
+
+private:
+    ClientSession(const ClientSession&);
+    ClientSession& operator=(const ClientSession&);
+
+    int fd;
+    std::string input;          // Received bytes not yet returned as a line
+    bool at_line_start = true;  // Whether the next output byte starts a line
+};
+
+class DaemonServer {
+public:
+    typedef std::function<void(ClientSession&)> Handler;
+
+    DaemonServer() {}
+    ~DaemonServer();
+
+    // Binds the socket; done before detaching so a bad path is reported on the terminal
+    bool listen(const std::string& path);
+
+    // Accepts clients, running handler on a thread per client, until stop(). Returns once
+    // every session has ended.
+    void serve(Handler handler);
+
+    // Safe from any thread, a session's included; disconnects every client
+    void stop();
+
+private:
+    DaemonServer(const DaemonServer&);
+    DaemonServer& operator=(const DaemonServer&);
+
+    struct Slot {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void reap(bool all);
+
+    std::string path;
+    int listener = -1;
+    std::atomic<bool> stopping{false};
+    std::mutex mtx;             // Guards slots
+    std::list<std::unique_ptr<Slot>> slots;
+};
+
+// Forks into the background: the parent prints started (with the child's pid appended) and
+// exits; the child leaves the terminal's session and sends its output to log_path. False,
+// still in the caller's process, if the fork failed.
+bool detachFromTerminal(const std::string& log_path, const std::string& started);
+
+// CSOPESYApp --attach: relays stdin to the daemon and its replies to stdout until the daemon
+// closes the connection or stdin ends. Returns the process exit code.
+int runClient(const std::string& path);
+
+#endif // DAEMON_SERVER_H
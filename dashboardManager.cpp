@@ -0,0 +1,143 @@
+#include "dashboardManager.h"
+#include <ncurses.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Formats one line of the frame (printf-style), truncated or padded later to the screen width
+static std::string formatLine(const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+static std::vector<std::string> buildFrame(const SchedulerSnapshot& snapshot, int rows, int cols, double render_ms) {
+    std::vector<std::string> frame;
+
+    std::time_t taken = std::chrono::system_clock::to_time_t(snapshot.taken_at);
+    char clock[16];
+    std::strftime(clock, sizeof(clock), "%H:%M:%S", std::localtime(&taken));
+
+    int busy_cores = 0;
+    for (const auto& core : snapshot.cores) {
+        if (core.busy) ++busy_cores;
+    }
+
+    frame.push_back(formatLine("top - %s  snapshot #%llu  render %.2f ms   (q to quit)",
+                               clock, snapshot.sequence, render_ms));
+    frame.push_back(formatLine("Cores: %d  busy: %d  quantum: %d   Processes: %zu live, %zu ready, %zu finished",
+                               snapshot.num_cores, busy_cores, snapshot.quantum_cycles,
+                               snapshot.process_count, snapshot.ready_count, snapshot.finished_count));
+
+    int memory_percent = snapshot.max_memory > 0 ? snapshot.used_memory * 100 / snapshot.max_memory : 0;
+    frame.push_back(formatLine("Memory: %d / %d KB (%d%%), %d per frame",
+                               snapshot.used_memory, snapshot.max_memory, memory_percent, snapshot.mem_per_frame));
+    std::string map = snapshot.memory_map.substr(0, std::max(0, cols - 3));
+    frame.push_back("[" + map + "]");
+    frame.push_back("");
+
+    frame.push_back(formatLine("%-5s %-6s %-8s %-16s %7s %12s %12s", "CORE", "STATE", "PID", "PROCESS", "READY",
+                               "ACTIVE", "IDLE"));
+    for (const auto& core : snapshot.cores) {
+        if (static_cast<int>(frame.size()) >= rows / 2) break;
+        frame.push_back(formatLine("%-5d %-6s %-8s %-16.16s %7d %12lld %12lld", core.core_id,
+                                   core.busy ? "busy" : "idle",
+                                   core.busy ? std::to_string(core.process_id).c_str() : "-",
+                                   core.busy ? core.process_name.c_str() : "-", core.ready_length,
+                                   core.active_ticks, core.idle_ticks));
+    }
+    frame.push_back("");
+
+    frame.push_back(formatLine("%-8s %-16s %5s %8s %17s %10s %-8s", "PID", "NAME", "CORE", "CPU", "PROGRESS",
+                               "MEM", "STATE"));
+    for (const auto& process : snapshot.top_processes) {
+        if (static_cast<int>(frame.size()) >= rows) break;
+        std::string progress = std::to_string(process.current_step) + "/" + std::to_string(process.total_instructions);
+        frame.push_back(formatLine("%-8d %-16.16s %5d %8d %17s %10d %-8s", process.id, process.name.c_str(),
+                                   process.core_id, process.current_step, progress.c_str(), process.memory,
+                                   process.running ? "running" : (process.in_memory ? "ready" : "waiting")));
+    }
+
+    // Pad every line to the full width so shorter text overwrites what was there before
+    frame.resize(std::max(rows, 0));
+    for (auto& line : frame) {
+        line.resize(std::max(cols, 0), ' ');
+    }
+    return frame;
+}
+
+// Writes only the runs of cells that differ from the previous frame, instead of clear() and a full repaint
+static void renderDiff(const std::vector<std::string>& frame, std::vector<std::string>& previous) {
+    for (size_t row = 0; row < frame.size(); ++row) {
+        const std::string& line = frame[row];
+        const std::string& old_line = previous[row];
+        size_t col = 0;
+        while (col < line.size()) {
+            if (col < old_line.size() && line[col] == old_line[col]) {
+                ++col;
+                continue;
+            }
+            size_t start = col;
+            while (col < line.size() && (col >= old_line.size() || line[col] != old_line[col])) {
+                ++col;
+            }
+            mvaddnstr(static_cast<int>(row), static_cast<int>(start), line.c_str() + start,
+                      static_cast<int>(col - start));
+        }
+    }
+    previous = frame;
+}
+
+void topDashboard(const SnapshotSource& source, int fps) {
+    initscr();
+    noecho();
+    curs_set(0);
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
+
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    std::vector<std::string> previous(rows, std::string(cols, ' '));
+
+    auto frame_interval = std::chrono::microseconds(1000000 / std::max(1, fps));
+    auto next_frame = std::chrono::steady_clock::now();
+    double render_ms = 0.0;
+
+    while (true) {
+        int ch = getch();
+        if (ch == 'q' || ch == 'Q') {
+            break;
+        }
+        if (ch == KEY_RESIZE) {
+            getmaxyx(stdscr, rows, cols);
+            clear(); // The only full repaint: the old frame no longer matches the terminal
+            previous.assign(rows, std::string(cols, ' '));
+        }
+
+        auto render_start = std::chrono::steady_clock::now();
+        std::shared_ptr<const SchedulerSnapshot> snapshot = source();
+        if (snapshot) {
+            renderDiff(buildFrame(*snapshot, rows, cols, render_ms), previous);
+            refresh();
+        }
+        render_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - render_start).count();
+
+        // Fixed frame rate: sleep until the next frame slot, skipping slots we have already missed
+        next_frame += frame_interval;
+        auto now = std::chrono::steady_clock::now();
+        if (next_frame < now) {
+            next_frame = now;
+        }
+        std::this_thread::sleep_until(next_frame);
+    }
+
+    endwin();
+}
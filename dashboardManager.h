@@ -0,0 +1,13 @@
+#ifndef DASHBOARD_MANAGER_H
+#define DASHBOARD_MANAGER_H
+
+#include <functional>
+#include <memory>
+#include "schedulerSnapshot.h"
+
+typedef std::function<std::shared_ptr<const SchedulerSnapshot>()> SnapshotSource;
+
+// Live top-style view of the scheduler; redraws at fps frames per second until 'q' is pressed
+void topDashboard(const SnapshotSource& source, int fps);
+
+#endif // DASHBOARD_MANAGER_H
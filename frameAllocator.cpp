@@ -0,0 +1,109 @@
+#include "frameAllocator.h"
+#include <algorithm>
+
+namespace {
+const int kWordBits = 64;
+
+uint64_t bitFor(int frame) {
+    return 1ULL << (frame % kWordBits);
+}
+}
+
+const int FrameAllocator::kMaxRegions;
+
+FrameAllocator::FrameAllocator(int frames) : cursors(new Cursor[kMaxRegions]) {
+    for (int region = 0; region < kMaxRegions; ++region) {
+        cursors[region].word.store(0);
+    }
+    reset(frames);
+}
+
+void FrameAllocator::reset(int frames) {
+    frame_count = std::max(0, frames);
+    word_count = (static_cast<size_t>(frame_count) + kWordBits - 1) / kWordBits;
+    words.reset(word_count > 0 ? new std::atomic<uint64_t>[word_count] : nullptr);
+    for (size_t word = 0; word < word_count; ++word) {
+        int frames_here = std::min(kWordBits, frame_count - static_cast<int>(word) * kWordBits);
+        words[word].store(frames_here == kWordBits ? ~0ULL : (1ULL << frames_here) - 1);
+    }
+    free_count.store(frame_count);
+    setRegions(region_count.load());
+}
+
+void FrameAllocator::setRegions(int regions) {
+    regions = std::max(1, std::min(regions, kMaxRegions));
+    for (int region = 0; region < regions; ++region) {
+        size_t first, last;
+        regionBounds(region, regions, first, last);
+        cursors[region].word.store(first, std::memory_order_relaxed);
+    }
+    region_count.store(regions);
+}
+
+void FrameAllocator::regionBounds(int region, int regions, size_t& first, size_t& last) const {
+    first = word_count * region / regions;
+    last = word_count * (region + 1) / regions;
+}
+
+bool FrameAllocator::isFree(int frame) const {
+    return (words[frame / kWordBits].load(std::memory_order_relaxed) & bitFor(frame)) != 0;
+}
+
+int FrameAllocator::allocate(int region) {
+    int regions = region_count.load(std::memory_order_relaxed);
+    region = region < 0 ? 0 : region % regions;
+    for (int step = 0; step < regions; ++step) {
+        int current = (region + step) % regions;
+        size_t first, last;
+        regionBounds(current, regions, first, last);
+        if (first == last) continue;
+        size_t span = last - first;
+        size_t start = cursors[current].word.load(std::memory_order_relaxed);
+        if (start < first || start >= last) start = first;
+
+        for (size_t i = 0; i < span; ++i) {
+            size_t word = start + i < last ? start + i : start + i - span;
+            uint64_t bits = words[word].load(std::memory_order_relaxed);
+            while (bits != 0) {
+                uint64_t lowest = bits & (~bits + 1);
+                if (words[word].compare_exchange_weak(bits, bits & ~lowest, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    free_count.fetch_sub(1, std::memory_order_relaxed);
+                    cursors[current].word.store(word, std::memory_order_relaxed);
+                    return static_cast<int>(word) * kWordBits + __builtin_ctzll(lowest);
+                }
+                // bits was reloaded by the failed exchange; retry on what is left
+            }
+        }
+    }
+    return -1;
+}
+
+bool FrameAllocator::claim(int frame) {
+    uint64_t bit = bitFor(frame);
+    if ((words[frame / kWordBits].fetch_and(~bit, std::memory_order_acquire) & bit) == 0) return false;
+    free_count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameAllocator::release(int frame) {
+    uint64_t bit = bitFor(frame);
+    if ((words[frame / kWordBits].fetch_or(bit, std::memory_order_release) & bit) == 0) {
+        free_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<bool> FrameAllocator::usedBits() const {
+    std::vector<bool> used(frame_count);
+    for (int frame = 0; frame < frame_count; ++frame) {
+        used[frame] = !isFree(frame);
+    }
+    return used;
+}
+
+void FrameAllocator::loadUsedBits(const std::vector<bool>& used) {
+    reset(frame_count);
+    for (int frame = 0; frame < frame_count && frame < static_cast<int>(used.size()); ++frame) {
+        if (used[frame]) claim(frame);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef FRAME_ALLOCATOR_H
+#define FRAME_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Lock-free map of free physical frames: one bit per frame, set while the frame is free.
+// Taking a frame is a compare-and-swap that clears its bit and freeing one is a fetch_or,
+// so cores allocate and free without any lock. The bitmap is split into one region per
+// core; each core searches its own region first, from where its last allocation succeeded,
+// so cores mostly work on different cache lines and only reach into other regions once
+// theirs is full.
+class FrameAllocator {
+public:
+    static const int kMaxRegions = 64;
+
+    explicit FrameAllocator(int frames = 0);
+
+    // Marks every frame free. Not thread-safe: only for setup, before frames are handed out.
+    void reset(int frames);
+
+    // Splits the map into regions (one per core); safe while other threads allocate
+    void setRegions(int regions);
+
+    int size() const { return frame_count; }
+    int freeFrames() const { return free_count.load(std::memory_order_relaxed); }
+    bool isFree(int frame) const;
+
+    // Takes a free frame, searching region first; -1 when every frame is in use
+    int allocate(int region);
+
+    // Takes a specific frame; false if it was already in use
+    bool claim(int frame);
+
+    void release(int frame);
+
+    // In-use map for checkpoints, and its inverse; load is setup-only like reset
+    std::vector<bool> usedBits() const;
+    void loadUsedBits(const std::vector<bool>& used);
+
+private:
+    FrameAllocator(const FrameAllocator&);
+    FrameAllocator& operator=(const FrameAllocator&);
+
+    // Where a region's last successful search ended, padded to its own cache line
+    struct Cursor {
+        std::atomic<size_t> word;
+        char pad[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    void regionBounds(int region, int regions, size_t& first, size_t& last) const;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+    size_t word_count = 0;
+    int frame_count = 0;
+    std::atomic<int> free_count{0};
+    std::atomic<int> region_count{1};
+    std::unique_ptr<Cursor[]> cursors;
+};
+
+#endif // FRAME_ALLOCATOR_H
@@ -0,0 +1,14 @@
+#ifndef HOST_TOPOLOGY_H
+#define HOST_TOPOLOGY_H
+
+#include <vector>
+
+// Host CPU placement helpers for the simulated core workers.
+// Pinning and NUMA lookup are Linux-only; elsewhere they report "unsupported" and do nothing.
+
+bool hostAffinitySupported();
+std::vector<int> allowedHostCpus();     // CPUs this process may run on, in ascending order
+int numaNodeOfCpu(int cpu);             // -1 when the node is unknown
+bool pinCurrentThreadToCpu(int cpu);    // sched_setaffinity on the calling thread
+
+#endif // HOST_TOPOLOGY_H
@@ -0,0 +1,138 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Min-heap with Arity children per node that remembers where each item sits, so an item's
+// key can be changed or the item removed in O(log n) without searching for it.
+// Position is a functor returning an int& slot stored with the item (-1 while not queued);
+// an item can therefore be in at most one IndexedHeap at a time.
+// Equal keys pop in insertion order.
+template <typename Item, typename Position, int Arity = 2>
+class IndexedHeap {
+public:
+    explicit IndexedHeap(Position position = Position()) : position(position) {}
+
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+    bool contains(const Item& item) const {
+        int slot = position(item);
+        return slot >= 0 && static_cast<size_t>(slot) < nodes.size() && nodes[slot].item == item;
+    }
+
+    void push(const Item& item, long long key) {
+        nodes.push_back(Node{key, next_sequence++, item});
+        position(item) = static_cast<int>(nodes.size() - 1);
+        siftUp(nodes.size() - 1);
+    }
+
+    const Item& top() const { return nodes.front().item; }
+    long long topKey() const { return nodes.front().key; }
+
+    Item pop() {
+        Item item = nodes.front().item;
+        removeAt(0);
+        return item;
+    }
+
+    // Moves an item after its key changed; decreases sift up, increases sift down
+    void update(const Item& item, long long key) {
+        size_t slot = static_cast<size_t>(position(item));
+        long long old_key = nodes[slot].key;
+        nodes[slot].key = key;
+        if (key < old_key) siftUp(slot);
+        else siftDown(slot);
+    }
+
+    void erase(const Item& item) {
+        removeAt(static_cast<size_t>(position(item)));
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto& node : nodes) {
+            visit(node.item, node.key);
+        }
+    }
+
+    void drainTo(std::vector<Item>& out) {
+        for (auto& node : nodes) {
+            position(node.item) = -1;
+            out.push_back(node.item);
+        }
+        nodes.clear();
+    }
+
+private:
+    struct Node {
+        long long key;
+        unsigned long long sequence; // Tie-breaker for equal keys
+        Item item;
+    };
+
+    std::vector<Node> nodes;
+    unsigned long long next_sequence = 0;
+    mutable Position position;
+
+    static bool before(const Node& a, const Node& b) {
+        return a.key < b.key || (a.key == b.key && a.sequence < b.sequence);
+    }
+
+    void place(size_t slot, Node&& node) {
+        nodes[slot] = std::move(node);
+        position(nodes[slot].item) = static_cast<int>(slot);
+    }
+
+    void siftUp(size_t slot) {
+        Node node = std::move(nodes[slot]);
+        while (slot > 0) {
+            size_t parent = (slot - 1) / Arity;
+            if (!before(node, nodes[parent])) break;
+            place(slot, std::move(nodes[parent]));
+            slot = parent;
+        }
+        place(slot, std::move(node));
+    }
+
+    void siftDown(size_t slot) {
+        Node node = std::move(nodes[slot]);
+        size_t count = nodes.size();
+        while (true) {
+            size_t first_child = slot * Arity + 1;
+            if (first_child >= count) break;
+            size_t best = first_child;
+            size_t last_child = first_child + Arity < count ? first_child + Arity : count;
+            for (size_t child = first_child + 1; child < last_child; ++child) {
+                if (before(nodes[child], nodes[best])) best = child;
+            }
+            if (!before(nodes[best], node)) break;
+            place(slot, std::move(nodes[best]));
+            slot = best;
+        }
+        place(slot, std::move(node));
+    }
+
+    void removeAt(size_t slot) {
+        position(nodes[slot].item) = -1;
+        size_t last = nodes.size() - 1;
+        if (slot != last) {
+            long long removed_key = nodes[slot].key;
+            unsigned long long removed_sequence = nodes[slot].sequence;
+            place(slot, std::move(nodes[last]));
+            nodes.pop_back();
+            const Node& moved = nodes[slot];
+            if (moved.key < removed_key || (moved.key == removed_key && moved.sequence < removed_sequence)) {
+                siftUp(slot);
+            } else {
+                siftDown(slot);
+            }
+        } else {
+            nodes.pop_back();
+        }
+    }
+};
+
+#endif // INDEXED_HEAP_H
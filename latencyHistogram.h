@@ -0,0 +1,64 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+
+// Fixed-size histogram of tick counts with two buckets per power of two, so recording is
+// cheap enough to do under the scheduler lock and copying one into a snapshot is a memcpy.
+// Bucket upper bounds (inclusive): 1, 2, 3, 4, 6, 8, 12, 16, 24, ... and a last bucket
+// for everything larger. Percentiles interpolate inside a bucket, so they are estimates
+// within half an octave.
+class LatencyHistogram {
+public:
+    static const int kBuckets = 48;
+
+    // Inclusive upper bound of a bucket; the last bucket has none and returns -1
+    static long long bucketBound(int bucket) {
+        if (bucket >= kBuckets - 1) return -1;
+        if (bucket == 0) return 1;
+        if (bucket % 2 == 1) return 1LL << ((bucket + 1) / 2);
+        return 3LL << ((bucket - 2) / 2);
+    }
+
+    void record(long long value) {
+        value = std::max(0LL, value);
+        int bucket = 0;
+        while (bucket < kBuckets - 1 && value > bucketBound(bucket)) ++bucket;
+        ++counts[bucket];
+        ++total;
+        sum += value;
+        largest = std::max(largest, value);
+    }
+
+    long long count() const { return total; }
+    long long valueSum() const { return sum; }
+    long long maximum() const { return largest; }
+    long long bucketCount(int bucket) const { return counts[bucket]; }
+
+    // p in [0, 1]; 0 when nothing has been recorded
+    double percentile(double p) const {
+        if (total == 0) return 0.0;
+        double target = std::min(1.0, std::max(0.0, p)) * total;
+        long long seen = 0;
+        for (int bucket = 0; bucket < kBuckets; ++bucket) {
+            if (counts[bucket] == 0 || seen + counts[bucket] < target) {
+                seen += counts[bucket];
+                continue;
+            }
+            double lower = bucket == 0 ? 0.0 : static_cast<double>(bucketBound(bucket - 1));
+            double upper = bucket == kBuckets - 1 ? static_cast<double>(largest) : static_cast<double>(bucketBound(bucket));
+            upper = std::min(upper, static_cast<double>(largest));
+            double fraction = (target - seen) / counts[bucket];
+            return lower + fraction * std::max(0.0, upper - lower);
+        }
+        return static_cast<double>(largest);
+    }
+
+private:
+    long long counts[kBuckets] = {0};
+    long long total = 0;
+    long long sum = 0;
+    long long largest = 0;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,119 @@
+#include "lzCompressor.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;    // The block always ends in literals, so decoding stops cleanly
+const size_t kMaxOffset = 65535;
+const int kHashBits = 12;
+
+uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void writeLength(std::vector<unsigned char>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<unsigned char>(length));
+}
+
+void writeSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literal_count,
+                   size_t offset, size_t match_length) {
+    size_t match_code = match_length >= kMinMatch ? match_length - kMinMatch : 0;
+    unsigned char token = static_cast<unsigned char>((literal_count < 15 ? literal_count : 15) << 4);
+    if (match_length > 0) token |= static_cast<unsigned char>(match_code < 15 ? match_code : 15);
+    out.push_back(token);
+    if (literal_count >= 15) writeLength(out, literal_count - 15);
+    out.insert(out.end(), literals, literals + literal_count);
+    if (match_length == 0) return;
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (match_code >= 15) writeLength(out, match_code - 15);
+}
+
+// Reads a 255-chained length extension; false if it runs off the end of the block
+bool readLength(const unsigned char* in, size_t in_size, size_t& pos, size_t& length) {
+    unsigned char byte;
+    do {
+        if (pos >= in_size) return false;
+        byte = in[pos++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+}
+
+size_t lzCompress(const unsigned char* in, size_t size, std::vector<unsigned char>& out) {
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+
+    uint32_t table[1 << kHashBits] = {0}; // Position + 1 of the last sequence with each hash
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t match_limit = size > kLastLiterals ? size - kLastLiterals : 0;
+
+    while (pos + kMinMatch <= match_limit) {
+        uint32_t sequence = read32(in + pos);
+        uint32_t& slot = table[hash4(sequence)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || read32(in + candidate - 1) != sequence) {
+            ++pos;
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t length = kMinMatch;
+        while (pos + length < match_limit && in[match + length] == in[pos + length]) {
+            ++length;
+        }
+        writeSequence(out, in + anchor, pos - anchor, pos - match, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    writeSequence(out, in + anchor, size - anchor, 0, 0);
+    return out.size();
+}
+
+bool lzDecompress(const unsigned char* in, size_t in_size, unsigned char* out, size_t size) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < in_size) {
+        unsigned char token = in[ip++];
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(in, in_size, ip, literals)) return false;
+        if (ip + literals > in_size || op + literals > size) return false;
+        std::memcpy(out + op, in + ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == in_size) break; // Last sequence: literals only
+
+        if (ip + 2 > in_size) return false;
+        size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return false;
+
+        size_t length = token & 15;
+        if (length == 15 && !readLength(in, in_size, ip, length)) return false;
+        length += kMinMatch;
+        if (op + length > size) return false;
+        // Byte by byte: the match may overlap the bytes it is producing
+        const unsigned char* from = out + op - offset;
+        for (size_t i = 0; i < length; ++i) {
+            out[op + i] = from[i];
+        }
+        op += length;
+    }
+    return op == size;
+}
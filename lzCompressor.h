@@ -0,0 +1,26 @@
+#ifndef LZ_COMPRESSOR_H
+#define LZ_COMPRESSOR_H
+
+#include <cstddef>
+#include <vector>
+
+// Small LZ77 block compressor in the style of LZ4: greedy matching through a hash table of
+// 4-byte sequences, 64 KiB window, no entropy coding. Fast enough to run on every page the
+// simulator swaps out.
+//
+// Block format, repeated until the input ends:
+//   token      high nibble = literal count, low nibble = match length - 4 (15 = more follows)
+//   [255...]   extra literal count bytes when the nibble is 15, ending with a byte < 255
+//   literals
+//   offset     2 bytes little-endian, distance back to the match (absent in the last sequence)
+//   [255...]   extra match length bytes when the nibble is 15
+// The last sequence carries only literals.
+
+// Replaces out with the compressed form of in[0, size); returns the compressed size
+size_t lzCompress(const unsigned char* in, size_t size, std::vector<unsigned char>& out);
+
+// Expands a block into out[0, size); false if the block is corrupt or does not expand to
+// exactly size bytes
+bool lzDecompress(const unsigned char* in, size_t in_size, unsigned char* out, size_t size);
+
+#endif // LZ_COMPRESSOR_H
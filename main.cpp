@@ -11,34 +11,166 @@
 #include <iomanip>
 #include <algorithm>
 #include <deque>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+#include <functional>
+#include <climits>
+#include <ctime>
+#include "configManager.h"
+#include "processIndex.h"
+#include "indexedHeap.h"
+#include "quantumController.h"
+#include "tlbSimulator.h"
+#include "schedulerSnapshot.h"
+#include "dashboardManager.h"
+#include "hostTopology.h"
+#include "workloadGenerator.h"
+#include "lzCompressor.h"
+#include "checkpoint.h"
+#include "metricsExport.h"
+#include "reportWriter.h"
+#include "frameAllocator.h"
+#include "clusterManager.h"
+#include "noticeBoard.h"
+#include "daemonServer.h"
 
-int num_cpu; // Move this to the global scope
+const int kTickMillis = 100; // Wall-clock length of one simulated CPU tick (one instruction)
+const int kLocalityPhase = 50; // Instructions a process stays within one page region
+const unsigned char kPageReferenced = 1;      // Cleared by the clock hand
+const unsigned char kPageUsedSinceSample = 2; // Cleared by each working-set sample
+const unsigned char kPageOnDisk = 4;          // A copy was written to the backing store
+const unsigned char kPageWriteback = 8;       // Evicted, still queued for the swap I/O stage to write
+const unsigned char kPagePrefetched = 16;     // Read ahead of use and not referenced since
 
- 
 struct Process {
     int id;
+    std::string name; // Screen name, "process<id>" for generated processes
     int core_id;
-    int current_step;
+    std::atomic<int> current_step; // Read by console and daemon session threads while a core runs it
     int total_instructions;
+    int memory_required; // Memory size requested at creation
     std::string start_time;
     std::atomic<bool> finished;
-    bool is_running = false;
+    std::atomic<bool> is_running{false};
     bool in_memory = false;
+    int queue_level = 0;             // MLFQ level; 0 is the highest priority
+    unsigned long long boost_epoch = 0; // Last MLFQ boost this process has seen
+    int heap_index = -1;             // Slot in a heap-ordered ready queue, -1 when not queued
+    std::atomic<int> priority{kDefaultPriority}; // 0 is the most urgent; changed by renice
+    long long queued_at = 0;         // Core clock when it joined a PriorityReadyQueue
+    long long deadline = 0;          // Relative deadline in ticks from arrival; 0 for best-effort work
+    bool realtime = false;           // Admitted to the EDF class; fixed once the process is created
+    int last_core = -1;              // Core this process last ran on, -1 before its first dispatch
+    long long last_ran_at = 0;       // That core's active ticks when the process last left it
+
+    // Admission: pending processes hold no memory and are not in any ready queue
+    unsigned long long pending_seq = 0; // Position in the pending queue's arrival order
+    int pending_frames = 0;          // Frames it asked for when it joined the pending queue
+    int bypassed = 0;                // Smaller processes admitted ahead of this one while it waited
+    bool swapped_out = false;        // Was resident, then swapped out to make room
+    int runs_since_admit = 0;        // Dispatches since the process last became resident
+    std::chrono::steady_clock::time_point last_active = std::chrono::steady_clock::now();
+
+    // Timing for turnaround/waiting/response statistics
+    std::chrono::steady_clock::time_point arrival_time = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point first_run_time, finish_time;
+    bool has_run = false;
     std::vector<int> allocated_frames; // Tracks memory frames allocated to this process
+    std::vector<int> huge_frames;      // Huge blocks backing the private part of the image, see MemoryManager
+
+    // Page sharing: the first shared_pages pages map frames of the program's shared image, the
+    // first code_pages of those are never written, and the rest are copied on first write
+    int program = -1;                  // Program this process runs; -1 when it shares nothing
+    int shared_pages = 0, code_pages = 0;
+    std::vector<int> cow_frames;       // Frame mapped for each shared page, private once copied
+    int shared_mapped = 0;             // Shared pages still mapped to the image
+    long long cow_faults = 0;
+    int committed_frames = 0;          // Frames admission counted for this process while it is resident
+
+    // Demand paging state, sized on first admission when paging is on
+    std::vector<int> page_frame;       // Frame holding each page, -1 when not resident
+    std::vector<unsigned char> page_bits; // kPage* flags
+    std::vector<unsigned char> page_age;  // Use in recent working-set samples, newest in bit 7
+    int resident_pages = 0;
+    int working_set = 0;               // Pages used within the working-set window; 0 before the first sample
+    long long page_faults = 0;
+    double fault_rate = 0.0;           // Faults per 100 instructions, smoothed over recent quanta
+    int quantum_faults = 0, quantum_steps = 0;
+    int locality_base = 0;             // First page of the region the process is currently using
+    bool swap_blocked = false;         // Waiting for the swap I/O stage to read a page in
+    int swap_retry_page = -1;          // Page the blocked instruction touches again when it resumes
 
     Process(int id, int total_instructions, int core_id)
-        : id(id), core_id(core_id), current_step(0), total_instructions(total_instructions), finished(false) {
+        : Process(id, total_instructions, total_instructions, core_id, currentTimestamp()) {}
+
+    // Batch constructor: the generator formats the timestamp once per batch
+    Process(int id, int total_instructions, int memory_required, int core_id, const std::string& start_time)
+        : id(id), name("process" + std::to_string(id)), core_id(core_id), current_step(0), total_instructions(total_instructions),
+          memory_required(memory_required), start_time(start_time), finished(false) {}
+
+    static std::string currentTimestamp() {
         auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
         std::stringstream ss;
         ss << std::put_time(std::localtime(&now), "%m/%d/%Y %I:%M:%S%p");
-        start_time = ss.str();
+        return ss.str();
+    }
+
+    int remaining() const {
+        return total_instructions - current_step;
+    }
+
+    std::chrono::steady_clock::time_point deadlineTime() const {
+        return arrival_time + std::chrono::milliseconds(deadline * kTickMillis);
+    }
+
+    // EDF order: the absolute deadline in milliseconds
+    long long deadlineKey() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(deadlineTime().time_since_epoch()).count();
+    }
+
+    // Share of a core it needs to finish by its deadline
+    double density() const {
+        return deadline > 0 ? static_cast<double>(total_instructions) / deadline : 0.0;
+    }
+
+    // In small frames; a huge block counts as the small frames it covers
+    int residentFrames(int huge_ratio = 0) const {
+        if (!page_frame.empty()) return resident_pages;
+        return static_cast<int>(allocated_frames.size() + huge_frames.size() * huge_ratio) + shared_mapped;
     }
 
-    int runQuantum(int quantum_cycles) {
+    // Page touched by the next instruction: references cluster in a region of a quarter of the
+    // pages, and the region moves every kLocalityPhase instructions
+    int nextPage(int pages) {
+        FastRandom& rng = FastRandom::threadLocal();
+        if (current_step % kLocalityPhase == 0) {
+            locality_base = rng.nextInt(0, pages - 1);
+        }
+        return (locality_base + rng.nextInt(0, std::max(1, pages / 4) - 1)) % pages;
+    }
+
+    // Runs up to quantum_cycles instructions; preempt is polled between instructions and
+    // before_step returns ticks to stall before each one (page fault service), or a negative
+    // value to block: the quantum ends and that instruction runs again on the next dispatch
+    int runQuantum(int quantum_cycles, const std::function<bool()>& preempt = std::function<bool()>(),
+                   const std::function<int()>& before_step = std::function<int()>()) {
         int cycles = 0;
         is_running = true;
         while (current_step < total_instructions && cycles < quantum_cycles) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (cycles > 0 && preempt && preempt()) {
+                break;
+            }
+            int stall = before_step ? before_step() : 0;
+            if (stall < 0) {
+                break;
+            }
+            if (stall > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(stall * kTickMillis));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(kTickMillis));
             ++current_step;
             ++cycles;
         }
@@ -51,33 +183,395 @@ struct Process {
 
     std::string getStatus() const {
         std::ostringstream status;
-        status << "Process " << id << " (" << start_time << ") Core: " << core_id
-               << "   " << current_step << " / " << total_instructions;
-        if (finished.load()) {
-            status << " [Finished]";
-        }
+        writeStatus(status, core_id, current_step.load(), finished.load());
         return status.str();
     }
+
+    // getStatus with the fields that change while the process runs passed in, so a row can be
+    // formatted later from values copied under the scheduler lock
+    void writeStatus(std::ostream& out, int at_core, int at_step, bool is_finished) const {
+        out << "Process " << id << " (" << start_time << ") Core: " << at_core
+            << "   " << at_step << " / " << total_instructions;
+        if (is_finished) {
+            out << " [Finished]";
+        }
+    }
+
+    // Checkpoint record. Clock readings are stored as milliseconds before now, so a restored
+    // process keeps its age; queue positions (heap_index, MLFQ boost epoch) are rebuilt on restore.
+    void save(CheckpointWriter& out, std::chrono::steady_clock::time_point now) const {
+        out.put<int32_t>(id);
+        out.putString(name);
+        out.put<int32_t>(core_id);
+        out.put<int32_t>(current_step);
+        out.put<int32_t>(total_instructions);
+        out.put<int32_t>(memory_required);
+        out.putString(start_time);
+        out.put<uint8_t>(finished.load());
+        out.put<uint8_t>(in_memory);
+        out.put<int32_t>(queue_level);
+        out.put<int32_t>(priority.load());
+        out.put<int64_t>(queued_at);
+        out.put<int64_t>(deadline);
+        out.put<uint8_t>(realtime);
+        out.put<int32_t>(last_core);
+        out.put<int64_t>(last_ran_at);
+        out.put<uint64_t>(pending_seq);
+        out.put<int32_t>(pending_frames);
+        out.put<int32_t>(bypassed);
+        out.put<uint8_t>(swapped_out);
+        out.put<int32_t>(runs_since_admit);
+        out.put<uint8_t>(has_run);
+        out.put<int64_t>(millisBefore(now, last_active));
+        out.put<int64_t>(millisBefore(now, arrival_time));
+        out.put<int64_t>(millisBefore(now, first_run_time));
+        out.put<int64_t>(millisBefore(now, finish_time));
+        out.putVector(allocated_frames);
+        out.putVector(huge_frames);
+        out.put<int32_t>(program);
+        out.put<int32_t>(shared_pages);
+        out.put<int32_t>(code_pages);
+        out.putVector(cow_frames);
+        out.put<int32_t>(shared_mapped);
+        out.put<int64_t>(cow_faults);
+        out.put<int32_t>(committed_frames);
+        out.putVector(page_frame);
+        out.putVector(page_bits);
+        out.putVector(page_age);
+        out.put<int32_t>(resident_pages);
+        out.put<int32_t>(working_set);
+        out.put<int64_t>(page_faults);
+        out.put<double>(fault_rate);
+        out.put<int32_t>(quantum_faults);
+        out.put<int32_t>(quantum_steps);
+        out.put<int32_t>(locality_base);
+        out.put<uint8_t>(swap_blocked);
+        out.put<int32_t>(swap_retry_page);
+    }
+
+    // Reads a record written by save; nullptr if the snapshot is damaged
+    static std::shared_ptr<Process> load(CheckpointReader& in, std::chrono::steady_clock::time_point now) {
+        const uint64_t kMaxPages = 1ULL << 31;
+        int id = in.get<int32_t>();
+        std::string name = in.getString();
+        int core_id = in.get<int32_t>();
+        int current_step = in.get<int32_t>();
+        int total_instructions = in.get<int32_t>();
+        int memory_required = in.get<int32_t>();
+        std::string start_time = in.getString();
+        auto process = std::make_shared<Process>(id, total_instructions, memory_required, core_id, start_time);
+        process->name = name;
+        process->current_step = current_step;
+        process->finished.store(in.get<uint8_t>() != 0);
+        process->in_memory = in.get<uint8_t>() != 0;
+        process->queue_level = in.get<int32_t>();
+        process->priority.store(in.get<int32_t>());
+        process->queued_at = in.get<int64_t>();
+        process->deadline = in.get<int64_t>();
+        process->realtime = in.get<uint8_t>() != 0;
+        process->last_core = in.get<int32_t>();
+        process->last_ran_at = in.get<int64_t>();
+        process->pending_seq = in.get<uint64_t>();
+        process->pending_frames = in.get<int32_t>();
+        process->bypassed = in.get<int32_t>();
+        process->swapped_out = in.get<uint8_t>() != 0;
+        process->runs_since_admit = in.get<int32_t>();
+        process->has_run = in.get<uint8_t>() != 0;
+        process->last_active = now - std::chrono::milliseconds(in.get<int64_t>());
+        process->arrival_time = now - std::chrono::milliseconds(in.get<int64_t>());
+        process->first_run_time = now - std::chrono::milliseconds(in.get<int64_t>());
+        process->finish_time = now - std::chrono::milliseconds(in.get<int64_t>());
+        in.getVector(process->allocated_frames, kMaxPages);
+        in.getVector(process->huge_frames, kMaxPages);
+        process->program = in.get<int32_t>();
+        process->shared_pages = in.get<int32_t>();
+        process->code_pages = in.get<int32_t>();
+        in.getVector(process->cow_frames, kMaxPages);
+        process->shared_mapped = in.get<int32_t>();
+        process->cow_faults = in.get<int64_t>();
+        process->committed_frames = in.get<int32_t>();
+        in.getVector(process->page_frame, kMaxPages);
+        in.getVector(process->page_bits, kMaxPages);
+        in.getVector(process->page_age, kMaxPages);
+        process->resident_pages = in.get<int32_t>();
+        process->working_set = in.get<int32_t>();
+        process->page_faults = in.get<int64_t>();
+        process->fault_rate = in.get<double>();
+        process->quantum_faults = in.get<int32_t>();
+        process->quantum_steps = in.get<int32_t>();
+        process->locality_base = in.get<int32_t>();
+        process->swap_blocked = in.get<uint8_t>() != 0;
+        process->swap_retry_page = in.get<int32_t>();
+
+        size_t pages = process->page_frame.size();
+        if (!in.ok() || process->page_bits.size() != pages || process->page_age.size() != pages ||
+            process->swap_retry_page >= static_cast<int>(pages) || process->locality_base < 0 ||
+            (pages > 0 && process->locality_base >= static_cast<int>(pages)) ||
+            (!process->cow_frames.empty() && process->cow_frames.size() != static_cast<size_t>(process->shared_pages))) {
+            return nullptr;
+        }
+        return process;
+    }
+
+private:
+    static long long millisBefore(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point then) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - then).count();
+    }
+};
+
+struct PageEviction {
+    int process_id = -1; // -1 when the fault took a free frame
+    int page = -1;
+};
+
+enum class PageFault {
+    None,
+    Minor,      // Still queued for write-back, so nothing had to be read
+    Compressed, // Decompressed from the compressed swap pool
+    Major       // Read from the backing store, or loaded for the first time
 };
 
+// Safe to call from any thread. Free frames live in a lock-free FrameAllocator with one region
+// per core, and the frame counters are atomics, so allocating or freeing a process's frames in
+// the plain frame model and reading occupancy never take a lock. Page tables, the clock, swap,
+// huge blocks and shared images are guarded by mem_mtx, which public methods take themselves
+// (it is recursive because they call each other). Lock order: scheduler mtx, then mem_mtx.
 class MemoryManager {
 public:
-    MemoryManager(int maxMemory, int memoryPerFrame)
-        : max_memory(maxMemory), mem_per_frame(memoryPerFrame), used_memory(0) {
+    // With paging on, admitted processes start with no frames and fault pages in on demand;
+    // ws_window is how many recent samples count towards a working set (1-8)
+    MemoryManager(int maxMemory, int memoryPerFrame, bool paging = false, int ws_window = 4)
+        : max_memory(maxMemory), mem_per_frame(memoryPerFrame), used_memory(0), paging(paging) {
         num_frames = max_memory / mem_per_frame;
-        memory_frames.resize(num_frames, false); // Initialize all frames as free
+        frames.reset(num_frames); // Every frame starts free
+        if (paging) {
+            frame_owner.resize(num_frames, nullptr);
+            frame_page.resize(num_frames, -1);
+        }
+        ws_window = std::max(1, std::min(ws_window, 8));
+        ws_mask = static_cast<unsigned char>(0xFF << (8 - ws_window));
+    }
+
+    bool pagingEnabled() const {
+        return paging;
+    }
+
+    // Second frame size: each huge frame is an aligned block of huge_size / mem_per_frame
+    // small frames and needs one frame-table entry and one TLB entry. Processes of at least
+    // threshold bytes get huge frames for the whole blocks of their image and small frames for
+    // the tail, falling back to small frames when no block is entirely free. With promote on,
+    // promoteFrames later moves a process's small frames into blocks that have freed up.
+    // Demand paging always works in small frames, so this only applies with paging off.
+    void enableHugeFrames(int huge_size, int threshold, bool promote) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (paging || huge_size <= mem_per_frame || huge_size % mem_per_frame != 0) {
+            return;
+        }
+        huge_ratio = huge_size / mem_per_frame;
+        huge_threshold = threshold > 0 ? threshold : huge_size;
+        huge_promote = promote;
+        block_used.assign(num_frames / huge_ratio, 0);
+        free_blocks = static_cast<int>(block_used.size());
+    }
+
+    // Resident size as the running core leaves it, read under mem_mtx since that core faults
+    // pages in without the scheduler lock
+    int residentBytes(const Process& process) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return process.residentFrames(huge_ratio) * mem_per_frame;
+    }
+
+    int hugeRatio() const {
+        return huge_ratio;
+    }
+
+    // Processes of the same program map one shared image for the first share_fraction of their
+    // pages. Half of that is code, which is never written; the other half is copied to a private
+    // frame on the first write. Like huge frames, this only applies with paging off.
+    void enableSharing(double share_fraction) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (paging || share_fraction <= 0.0) return;
+        sharing = true;
+        shared_fraction = std::min(1.0, share_fraction);
+        frame_refs.assign(num_frames, 0);
+    }
+
+    bool sharingEnabled() const {
+        return sharing;
+    }
+
+    // Compressed swap pool in front of the backing store, the way zram/zswap work: evicted pages
+    // are compressed into pool_bytes of memory set aside from the frame pool, and only go to the
+    // backing store if they compress poorly or the pool is full, in which case the oldest pooled
+    // pages are written back first. Swapping is per page, so this only applies with paging on.
+    // Call before anything is allocated.
+    void enableCompressedSwap(int pool_bytes) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!paging || pool_bytes <= 0) return;
+        int reserved = std::min((pool_bytes + mem_per_frame - 1) / mem_per_frame, num_frames / 2);
+        if (reserved == 0) return;
+        num_frames -= reserved;
+        frames.reset(num_frames);
+        frame_owner.resize(num_frames);
+        frame_page.resize(num_frames);
+        pool_capacity = static_cast<long long>(reserved) * mem_per_frame;
+        used_memory += static_cast<int>(pool_capacity);
+        page_buffer.resize(mem_per_frame);
+    }
+
+    // Drops a finished process's pages from swap
+    void freeSwap(Process& process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        write_queue.erase(std::remove_if(write_queue.begin(), write_queue.end(),
+                                         [&process](const std::pair<Process*, int>& queued) {
+                                             return queued.first == &process;
+                                         }),
+                          write_queue.end());
+        for (size_t page = 0; page < process.page_bits.size(); ++page) {
+            process.page_bits[page] &= ~(kPageOnDisk | kPageWriteback);
+            auto entry = pool.find(poolKey(process.id, static_cast<int>(page)));
+            if (entry != pool.end()) dropPooled(entry);
+        }
+    }
+
+    // Backing-store traffic, and with the pool on, how much of it the pool absorbed
+    void writeSwapStats(std::ostream& out) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!paging) return;
+        out << "Backing-store I/O: " << disk_writes << " page writes, " << disk_reads << " page reads\n";
+        if (pool_capacity == 0) return;
+        out << "Compressed pool: " << pool_used << " / " << pool_capacity << " bytes ("
+            << pool_used * 100 / pool_capacity << "%), " << pool.size() << " pages\n";
+        out << std::fixed << std::setprecision(2);
+        out << "Compression ratio: "
+            << (pool_used > 0 ? static_cast<double>(pool.size()) * mem_per_frame / pool_used : 0.0)
+            << ":1 in the pool, " << pool_rejects << " pages rejected as incompressible\n";
+        out.unsetf(std::ios::floatfield);
+        out << "Pool stores: " << pool_stores << ", loads: " << pool_loads << ", written back when full: "
+            << pool_writebacks << "\n";
+        out << "Backing-store I/O saved: " << pool_stores - pool_writebacks << " writes, " << pool_loads << " reads\n";
+        long long compressions = pool_stores + pool_rejects;
+        out << "Compression CPU: " << compress_nanos / 1000 << " us compressing ("
+            << (compressions > 0 ? compress_nanos / compressions : 0) << " ns/page), " << decompress_nanos / 1000
+            << " us decompressing (" << (pool_loads > 0 ? decompress_nanos / pool_loads : 0) << " ns/page)\n";
+    }
+
+    // One allocator region per core, so cores faulting at the same time take frames from
+    // different parts of the frame map
+    void setRegions(int regions) {
+        frames.setRegions(regions);
+    }
+
+    // Region the calling thread allocates from first; core workers set theirs to their core id
+    static void setThreadRegion(int region) {
+        threadRegion() = region;
+    }
+
+    // Every counter as of one instant: mem_mtx is held while they are copied, so nothing that
+    // changes two of them together (a fault, a release) is seen half done. The fragmentation
+    // scan reads the lock-free frame bitmap after mem_mtx is released, so faulting cores never
+    // wait on an O(frames) pass.
+    MemorySnapshot stats() const {
+        MemorySnapshot view;
+        std::unique_lock<std::recursive_mutex> lock(mem_mtx);
+        view.max_memory = max_memory;
+        view.used_memory = used_memory;
+        view.mem_per_frame = mem_per_frame;
+        view.huge_ratio = huge_ratio;
+        view.total_frames = num_frames;
+        view.frames_in_use = frames_in_use;
+        view.committed_frames = committed_frames;
+        view.paging = paging;
+        view.page_faults = total_faults;
+        view.evictions = evictions;
+        view.recent_fault_rate = recent_fault_rate;
+        view.disk_writes = disk_writes;
+        view.disk_reads = disk_reads;
+        view.pool_capacity = pool_capacity;
+        view.pool_used = pool_used;
+        view.pool_pages = static_cast<long long>(pool.size());
+        view.pool_stores = pool_stores;
+        view.pool_loads = pool_loads;
+        view.prefetched = prefetched;
+        view.prefetch_hits = prefetch_hits;
+        view.cow_faults = cow_faults;
+        lock.unlock();
+        view.external_fragmentation = calculateExternalFragmentation();
+        return view;
+    }
+
+    // A write by process to one of its pages; returns true if it took a copy-on-write fault
+    bool writePage(Process& process, int page) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (page < process.code_pages || page >= process.shared_pages) return false;
+        int frame = process.cow_frames[page];
+        if (frame_refs[frame] == 0) return false; // Already a private copy
+
+        std::vector<int> copy;
+        if (!takeFrames(1, copy)) return false;   // Cannot happen while the COW reserve is committed
+        process.allocated_frames.push_back(copy[0]);
+        process.cow_frames[page] = copy[0];
+        --frame_refs[frame];
+        --process.shared_mapped;
+        --shared_mappings;
+        ++process.cow_faults;
+        ++cow_faults;
+        return true;
+    }
+
+    void writeSharingStats(std::ostream& out) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!sharing) return;
+        out << "Shared frames: " << image_frames << " (" << images.size() << " program images), private frames: "
+            << frames_in_use - image_frames << "\n";
+        out << "Shared mappings: " << shared_mappings << " (saving " << std::max(0LL, shared_mappings - image_frames)
+            << " frames), copy-on-write faults: " << cow_faults << "\n";
     }
 
     int getMemPerFrame() const {
         return mem_per_frame;
     }
 
+    int framesFor(const Process& process) const {
+        return (process.memory_required + mem_per_frame - 1) / mem_per_frame;
+    }
+
+    int totalFrames() const {
+        return num_frames;
+    }
+
     bool allocateMemory(std::shared_ptr<Process> process) {
-        int frames_needed = (process->total_instructions + mem_per_frame - 1) / mem_per_frame;
+        if (plainFrames()) return allocatePlain(*process);
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (paging) {
+            // Nothing is loaded up front; admission only reserves the working set
+            int demand = demandFrames(*process);
+            if (demand > uncommittedFrames()) return false;
+            if (process->page_frame.empty()) {
+                int pages = std::max(1, framesFor(*process));
+                process->page_frame.assign(pages, -1);
+                process->page_bits.assign(pages, 0);
+                process->page_age.assign(pages, 0);
+            }
+            commit(*process, demand);
+            process->in_memory = true;
+            return true;
+        }
+
+        layoutSharedPages(*process);
+        int shared = process->shared_pages;
+        bool new_image = shared > 0 && images.find(process->program) == images.end();
+        int frames_needed = (process->memory_required + mem_per_frame - 1) / mem_per_frame - shared;
 
-        if (availableFrames() >= frames_needed) {
-            allocateFrames(process, frames_needed);
-            used_memory += frames_needed * mem_per_frame; // Update memory usage
+        if (availableFrames() >= frames_needed + (new_image ? shared : 0) &&
+            (shared == 0 || demandFrames(*process) <= uncommittedFrames())) {
+            if (shared > 0) mapSharedImage(*process);
+            int huge_wanted = huge_ratio > 0 && process->memory_required >= huge_threshold ? frames_needed / huge_ratio : 0;
+            int huge_got = allocateHugeFrames(*process, huge_wanted);
+            if (huge_got < huge_wanted) ++huge_fallbacks;
+            allocateFrames(process, frames_needed - huge_got * huge_ratio); // Also updates used_memory
+            // Private frames plus room to copy every writable shared page
+            commit(*process, frames_needed + shared - process->code_pages);
             process->in_memory = true; // Confirm process is now in memory
             return true;
         } else {
@@ -88,22 +582,213 @@ public:
 
 
     void releaseMemory(std::shared_ptr<Process> process) {
+        if (plainFrames()) {
+            releasePlain(*process);
+            return;
+        }
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
         for (auto frame : process->allocated_frames) {
-            memory_frames[frame] = false; // Free the frames
+            frames.release(frame);
+            releaseSmallFrame(frame);
         }
         used_memory -= process->allocated_frames.size() * mem_per_frame;
+        frames_in_use -= static_cast<int>(process->allocated_frames.size());
         process->allocated_frames.clear();
+        for (int block : process->huge_frames) {
+            releaseBlock(block);
+        }
+        process->huge_frames.clear();
+        unmapSharedImage(*process);
+        for (size_t page = 0; page < process->page_frame.size(); ++page) {
+            int frame = process->page_frame[page];
+            if (frame < 0) continue;
+            frames.release(frame);
+            frame_owner[frame] = nullptr;
+            frame_page[frame] = -1;
+            used_memory -= mem_per_frame;
+            --frames_in_use;
+            process->page_frame[page] = -1;
+            process->page_bits[page] &= kPageOnDisk | kPageWriteback;
+        }
+        process->resident_pages = 0;
+        commit(*process, 0);
         process->in_memory = false;
     }
 
+    // Frames a process needs to run without thrashing: its whole image without paging,
+    // its working set (or a quarter of its pages before the first sample) with paging
+    int demandFrames(const Process& process) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (sharing && process.program >= 0) {
+            // Shared code is free once the image exists; writable shared pages reserve a copy
+            int pages = framesFor(process);
+            int shared = static_cast<int>(pages * shared_fraction);
+            int code = shared / 2;
+            auto image = images.find(process.program);
+            bool mapped = image != images.end() && static_cast<int>(image->second.frames.size()) == shared;
+            return pages - code + (mapped ? 0 : shared);
+        }
+        if (!paging) return framesFor(process);
+        if (process.working_set > 0) return process.working_set;
+        return std::max(1, framesFor(process) / 4);
+    }
+
+    // Frames not yet promised to a resident process; with paging this can go negative
+    // when working sets grow past physical memory
+    int uncommittedFrames() const {
+        return num_frames - committed_frames;
+    }
+
+    int committedFrames() const {
+        return committed_frames;
+    }
+
+    // One memory access by process; returns the kind of page fault it took, if any. Free frames
+    // are used first, then the clock hand evicts the first page whose reference bit is clear and
+    // swaps it out; the evicted page is reported through evicted so stale translations can be
+    // shot down.
+    PageFault reference(Process& process, int page, PageEviction* evicted = nullptr, bool* prefetch_hit = nullptr) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        ++window_references;
+        if (process.page_frame[page] >= 0) {
+            if (process.page_bits[page] & kPagePrefetched) {
+                ++prefetch_hits;
+                if (prefetch_hit) *prefetch_hit = true;
+            }
+            process.page_bits[page] = (process.page_bits[page] & ~kPagePrefetched) | kPageReferenced | kPageUsedSinceSample;
+            return PageFault::None;
+        }
+
+        ++process.page_faults;
+        ++process.quantum_faults;
+        ++total_faults;
+        ++window_faults;
+        if (window_references >= kFaultRateWindow) {
+            recent_fault_rate = 100.0 * window_faults / window_references;
+            window_faults = 0;
+            window_references = 0;
+        }
+
+        PageFault fault = installPage(process, page, evicted);
+        process.page_bits[page] = kPageReferenced | kPageUsedSinceSample;
+        return fault;
+    }
+
+    // Reads a page in ahead of use without counting a fault; false if it is already resident
+    // or the process is no longer in memory. It gets one clock pass to be used before it can
+    // be evicted.
+    bool prefetch(Process& process, int page, PageEviction* evicted = nullptr) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!process.in_memory || process.page_frame.empty() || process.page_frame[page] >= 0) return false;
+        installPage(process, page, evicted);
+        process.page_bits[page] = kPageReferenced | kPagePrefetched;
+        ++prefetched;
+        return true;
+    }
+
+    bool isResident(const Process& process, int page) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return !process.page_frame.empty() && process.page_frame[page] >= 0;
+    }
+
+    // Write-behind: with async on, evicted pages are queued instead of being compressed or
+    // written on the faulting thread, and flushSwapWrite performs them one at a time
+    void setAsyncSwap(bool async) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        async_writes = paging && async;
+    }
+
+    size_t queuedSwapWrites() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return write_queue.size();
+    }
+
+    // Writes the oldest queued page that still needs it; returns true if that went to the
+    // backing store rather than the compressed pool, so the caller can charge the I/O time
+    bool flushSwapWrite() {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        while (!write_queue.empty()) {
+            std::pair<Process*, int> next = write_queue.front();
+            write_queue.pop_front();
+            unsigned char& bits = next.first->page_bits[next.second];
+            if (!(bits & kPageWriteback)) continue; // Faulted back in, or written already
+            bits &= ~kPageWriteback;
+            return storePage(*next.first, next.second);
+        }
+        return false;
+    }
+
+    long long prefetchedPages() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return prefetched;
+    }
+
+    long long prefetchHits() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return prefetch_hits;
+    }
+
+    long long prefetchesUnused() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return prefetch_unused;
+    }
+
+    long long writebackRescues() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return writeback_rescues;
+    }
+
+    // Called at the end of each quantum: shifts this quantum's use into every page's aging
+    // register, recounts the working set and refreshes the process's fault rate
+    void sampleWorkingSet(Process& process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!paging || process.page_frame.empty()) return;
+        int working_set = 0;
+        for (size_t page = 0; page < process.page_age.size(); ++page) {
+            unsigned char used = (process.page_bits[page] & kPageUsedSinceSample) ? 0x80 : 0;
+            process.page_age[page] = static_cast<unsigned char>((process.page_age[page] >> 1) | used);
+            process.page_bits[page] &= ~kPageUsedSinceSample;
+            if (process.page_age[page] & ws_mask) ++working_set;
+        }
+        process.working_set = std::max(1, working_set);
+        if (process.quantum_steps > 0) {
+            double rate = 100.0 * process.quantum_faults / process.quantum_steps;
+            process.fault_rate = process.fault_rate == 0.0 ? rate : 0.5 * (process.fault_rate + rate);
+        }
+        process.quantum_faults = 0;
+        process.quantum_steps = 0;
+        if (process.in_memory) commit(process, process.working_set);
+    }
+
+    double recentFaultRate() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return recent_fault_rate;
+    }
+
+    long long totalFaults() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return total_faults;
+    }
+
+    long long totalEvictions() const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        return evictions;
+    }
+
     void addToBackingStore(std::shared_ptr<Process> process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
         if (process->in_memory) {
+            // Resident pages are swapped out rather than dropped, so they fault back in from swap
+            for (size_t page = 0; paging && page < process->page_frame.size(); ++page) {
+                if (process->page_frame[page] >= 0) swapOutPage(*process, static_cast<int>(page));
+            }
             releaseMemory(process);
         }
         backing_store.push_back(process);
     }
 
     void loadFromBackingStore(std::shared_ptr<Process> process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
         if (allocateMemory(process)) {
             // Successfully brought back into memory
             backing_store.erase(
@@ -114,31 +799,28 @@ public:
     }
 
     bool allocatePages(std::shared_ptr<Process> process, int pages_needed) {
-        if (availableFrames() < pages_needed) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!takeFrames(pages_needed, process->allocated_frames)) {
             return false; // Not enough frames
         }
-        for (int i = 0; i < memory_frames.size() && pages_needed > 0; ++i) {
-            if (!memory_frames[i]) {
-                memory_frames[i] = true;
-                process->allocated_frames.push_back(i);
-                --pages_needed;
-            }
-        }
-        used_memory += pages_needed * mem_per_frame;
         process->in_memory = true;
         return true;
     }
 
     void deallocatePages(std::shared_ptr<Process> process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
         for (auto frame : process->allocated_frames) {
-            memory_frames[frame] = false; // Free the frame
+            frames.release(frame);
+            releaseSmallFrame(frame);
         }
+        frames_in_use -= static_cast<int>(process->allocated_frames.size());
         used_memory -= process->allocated_frames.size() * mem_per_frame;
         process->allocated_frames.clear();
         process->in_memory = false;
     }
 
     void loadPageFromBackingStore(std::shared_ptr<Process> process, int page_index) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
         if (allocatePages(process, 1)) {
             backing_store.erase(
                 std::remove_if(backing_store.begin(), backing_store.end(),
@@ -155,8 +837,8 @@ public:
         int fragmentation = 0;
         int free_contiguous = 0; // Declare this only once
 
-        for (bool frame : memory_frames) {
-            if (!frame) {
+        for (int frame = 0; frame < num_frames; ++frame) {
+            if (frames.isFree(frame)) {
                 ++free_contiguous;
             } else {
                 fragmentation += free_contiguous * mem_per_frame;
@@ -184,420 +866,3752 @@ public:
     }
 
     int availableFrames() const {
-        return std::count(memory_frames.begin(), memory_frames.end(), false);
+        return num_frames - frames_in_use;
     }
 
-private:
-    int max_memory, mem_per_frame, num_frames, used_memory;
-    std::vector<bool> memory_frames;
-    std::deque<std::shared_ptr<Process>> backing_store;
-
-    void allocateFrames(std::shared_ptr<Process> process, int frames_needed) {
-        process->allocated_frames.clear();
-        for (int i = 0; i < memory_frames.size() && frames_needed > 0; ++i) {
-            if (!memory_frames[i]) {
-                memory_frames[i] = true;
-                process->allocated_frames.push_back(i);
-                --frames_needed;
-                used_memory += mem_per_frame;  // Update used memory
+    // Moves a resident process's small frames into fully free huge blocks, one block's worth
+    // at a time, so it needs fewer frame-table and TLB entries. Returns blocks promoted.
+    int promoteFrames(Process& process) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (!huge_promote || !process.in_memory || process.memory_required < huge_threshold) return 0;
+        if (!process.cow_frames.empty()) return 0; // Copies are referenced from cow_frames too
+        int promoted = 0;
+        while (free_blocks > 0 && static_cast<int>(process.allocated_frames.size()) >= huge_ratio) {
+            // Copy the last huge_ratio small frames into the block, then free them
+            if (allocateHugeFrames(process, 1) == 0) break;
+            for (int i = 0; i < huge_ratio; ++i) {
+                int frame = process.allocated_frames.back();
+                process.allocated_frames.pop_back();
+                frames.release(frame);
+                releaseSmallFrame(frame);
+                --frames_in_use;
+                used_memory -= mem_per_frame;
             }
+            ++promoted;
+            ++huge_promotions;
         }
-        process->in_memory = true;
+        return promoted;
     }
 
-};
+    // Key a page is cached under in the TLB: pages inside one huge frame share an entry
+    int tlbKey(const Process& process, int page) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        int private_page = page - process.shared_pages;
+        if (huge_ratio > 0 && private_page >= 0 && private_page < static_cast<int>(process.huge_frames.size()) * huge_ratio) {
+            return kHugeTlbKey | (private_page / huge_ratio);
+        }
+        return page;
+    }
 
-// Function prototypes for commands
-void processSMI(const MemoryManager& memory_manager, const std::vector<std::shared_ptr<Process>>& processes);
-void vmStat(const MemoryManager& memory_manager, int idle_ticks, int active_ticks);
+    // Frame-table split between the two sizes, printed under vmstat
+    void writeFrameStats(std::ostream& out) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        if (huge_ratio == 0) return;
+        int huge_in_use = static_cast<int>(block_used.size()) - free_blocks - split_blocks;
+        int small_in_use = frames_in_use - huge_in_use * huge_ratio;
+        out << "Huge frames (" << huge_ratio * mem_per_frame << " bytes): " << huge_in_use << " in use, "
+            << free_blocks << " free, " << split_blocks << " split into small frames\n";
+        out << "Small frames (" << mem_per_frame << " bytes): " << small_in_use << " in use\n";
+        out << "Frame-table entries: " << (huge_in_use + small_in_use) << " (" << frames_in_use
+            << " with small frames only)\n";
+        out << "Huge fallbacks: " << huge_fallbacks << ", promotions: " << huge_promotions << "\n";
+    }
 
-// Other parts of the program remain unchanged from your provided code.
-// Add or integrate these functions as required.
+    // Holds mem_mtx for the caller until the lock is released: with it, per-process page tables
+    // and the frame map cannot change, so a checkpoint can save both as of one instant
+    std::unique_lock<std::recursive_mutex> lockState() const {
+        return std::unique_lock<std::recursive_mutex>(mem_mtx);
+    }
 
+    // Frame map, backing-store index, swap pool and counters. Geometry comes first, so a snapshot
+    // is only loaded into a manager built from the same memory configuration.
+    void saveState(CheckpointWriter& out) const {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        out.put<int32_t>(max_memory);
+        out.put<int32_t>(mem_per_frame);
+        out.put<int32_t>(num_frames);
+        out.put<uint8_t>(paging);
+        out.put<int32_t>(huge_ratio);
+        out.put<uint8_t>(sharing);
+        out.put<int64_t>(pool_capacity);
 
-class Scheduler {
-public:
-    virtual void startScheduler() = 0;
-    virtual void stopScheduler() = 0;
-    virtual void displayStatus() = 0;
-    virtual void generateUtilizationReport() = 0;
-    virtual ~Scheduler() = default;
-};
+        out.put<int32_t>(used_memory);
+        out.put<int32_t>(frames_in_use);
+        out.put<int32_t>(committed_frames);
+        out.putBits(frames.usedBits());
+        out.put<uint64_t>(backing_store.size());
+        for (const auto& process : backing_store) out.put<int32_t>(process->id);
 
+        out.putVector(block_used);
+        out.put<int32_t>(free_blocks);
+        out.put<int32_t>(split_blocks);
+        out.put<int64_t>(huge_fallbacks);
+        out.put<int64_t>(huge_promotions);
 
-class RoundRobinScheduler : public Scheduler {
-    int quantum_cycles, min_ins, max_ins, batch_process_freq, num_cores, delays_per_exec;
-    std::atomic<bool> scheduler_running{false};
-    std::atomic<bool> generator_running{false};
-    mutable std::mutex mtx; // Make sure it's mutable if accessed by const methods.
-    std::thread scheduler_thread, generator_thread;
-    std::vector<std::shared_ptr<Process>> process_queue, finished_processes;
-    MemoryManager memory_manager;
-    int quantum_cycle_counter = 0;
+        out.putVector(frame_refs);
+        out.put<int32_t>(image_frames);
+        out.put<int64_t>(shared_mappings);
+        out.put<int64_t>(cow_faults);
+        out.put<uint64_t>(images.size());
+        for (const auto& image : images) {
+            out.put<int32_t>(image.first);
+            out.put<int32_t>(image.second.users);
+            out.putVector(image.second.frames);
+        }
 
-public:
-    RoundRobinScheduler(int quantum, int minIns, int maxIns, int batchFreq, int numCores, int delaysExec, MemoryManager memoryManager)
-        : quantum_cycles(quantum), min_ins(minIns), max_ins(maxIns), batch_process_freq(batchFreq),
-          num_cores(numCores), delays_per_exec(delaysExec), memory_manager(memoryManager) {}
+        std::vector<int32_t> owners(frame_owner.size(), -1);
+        for (size_t frame = 0; frame < frame_owner.size(); ++frame) {
+            if (frame_owner[frame]) owners[frame] = frame_owner[frame]->id;
+        }
+        out.putVector(owners);
+        out.putVector(frame_page);
+        out.put<uint64_t>(clock_hand);
+        out.put<int64_t>(total_faults);
+        out.put<int64_t>(evictions);
+        out.put<int32_t>(window_faults);
+        out.put<int32_t>(window_references);
+        out.put<double>(recent_fault_rate);
 
-    std::vector<std::shared_ptr<Process>> getProcessQueue() const {
-        std::lock_guard<std::mutex> lock(mtx);
-        return process_queue;
+        out.put<int64_t>(pool_used);
+        out.put<uint64_t>(pool_order.size());
+        for (long long key : pool_order) {
+            const PooledPage& entry = pool.at(key);
+            out.put<int32_t>(entry.owner->id);
+            out.put<int32_t>(entry.page);
+            out.putVector(entry.data);
+        }
+        out.put<uint64_t>(write_queue.size());
+        for (const auto& queued : write_queue) {
+            out.put<int32_t>(queued.first->id);
+            out.put<int32_t>(queued.second);
+        }
+        const long long counters[] = {pool_stores, pool_loads, pool_rejects, pool_writebacks, disk_writes, disk_reads,
+                                      compress_nanos, decompress_nanos, prefetched, prefetch_hits, prefetch_unused,
+                                      writeback_rescues};
+        for (long long counter : counters) out.put<int64_t>(counter);
     }
 
-    int calculateIdleTicks(int total_cores, int active_cores, int quantum_cycles) {
-        return (total_cores - active_cores) * quantum_cycles;
-    }
+    // Inverse of saveState; processes maps every process in the snapshot by id. Returns false,
+    // with error set, if the geometry differs or the state does not add up; the manager must
+    // then be discarded.
+    bool loadState(CheckpointReader& in, const std::unordered_map<int, std::shared_ptr<Process>>& processes,
+                   std::string& error) {
+        std::lock_guard<std::recursive_mutex> lock(mem_mtx);
+        int saved_memory = in.get<int32_t>();
+        int saved_frame = in.get<int32_t>();
+        int saved_frames = in.get<int32_t>();
+        bool saved_paging = in.get<uint8_t>() != 0;
+        int saved_huge = in.get<int32_t>();
+        bool saved_sharing = in.get<uint8_t>() != 0;
+        long long saved_pool = in.get<int64_t>();
+        if (saved_memory != max_memory || saved_frame != mem_per_frame || saved_frames != num_frames ||
+            saved_paging != paging || saved_huge != huge_ratio || saved_sharing != sharing || saved_pool != pool_capacity) {
+            error = "the memory configuration (max-overall-mem, mem-per-frame, paging, huge frames, sharing or "
+                    "zswap-pool-size) differs from the checkpoint";
+            return false;
+        }
+        auto lookup = [&processes](int id) -> Process* {
+            auto found = processes.find(id);
+            return found == processes.end() ? nullptr : found->second.get();
+        };
+        const uint64_t frames = static_cast<uint64_t>(num_frames);
 
-    int calculateActiveTicks(int active_cores, int quantum_cycles) {
-        return active_cores * quantum_cycles;
-    }
+        used_memory = in.get<int32_t>();
+        frames_in_use = in.get<int32_t>();
+        committed_frames = in.get<int32_t>();
+        std::vector<bool> used;
+        in.getBits(used, frames);
+        backing_store.clear();
+        uint64_t swapped = in.get<uint64_t>();
+        for (uint64_t i = 0; i < swapped && in.ok(); ++i) {
+            auto found = processes.find(in.get<int32_t>());
+            if (found == processes.end()) break;
+            backing_store.push_back(found->second);
+        }
+        if (backing_store.size() != swapped) return corrupt(error);
 
+        in.getVector(block_used, frames);
+        free_blocks = in.get<int32_t>();
+        split_blocks = in.get<int32_t>();
+        huge_fallbacks = in.get<int64_t>();
+        huge_promotions = in.get<int64_t>();
 
-    int getQuantumCycles() const {
-        return quantum_cycles;
-    }
+        in.getVector(frame_refs, frames);
+        image_frames = in.get<int32_t>();
+        shared_mappings = in.get<int64_t>();
+        cow_faults = in.get<int64_t>();
+        images.clear();
+        uint64_t image_count = in.get<uint64_t>();
+        for (uint64_t i = 0; i < image_count && in.ok(); ++i) {
+            SharedImage& image = images[in.get<int32_t>()];
+            image.users = in.get<int32_t>();
+            in.getVector(image.frames, frames);
+            if (!framesValid(image.frames)) return corrupt(error);
+        }
 
+        std::vector<int32_t> owners;
+        in.getVector(owners, frames);
+        in.getVector(frame_page, frames);
+        if (paging && (owners.size() != frames || frame_page.size() != frames)) return corrupt(error);
+        for (size_t frame = 0; frame < owners.size(); ++frame) {
+            frame_owner[frame] = owners[frame] < 0 ? nullptr : lookup(owners[frame]);
+            if (owners[frame] >= 0 && !frame_owner[frame]) return corrupt(error);
+            // And the other way: an owned frame holds a page its owner maps to it
+            Process* owner = frame_owner[frame];
+            if (owner && (frame_page[frame] < 0 || frame_page[frame] >= static_cast<int>(owner->page_frame.size()) ||
+                          owner->page_frame[frame_page[frame]] != static_cast<int>(frame))) {
+                return corrupt(error);
+            }
+        }
+        clock_hand = static_cast<size_t>(in.get<uint64_t>());
+        total_faults = in.get<int64_t>();
+        evictions = in.get<int64_t>();
+        window_faults = in.get<int32_t>();
+        window_references = in.get<int32_t>();
+        recent_fault_rate = in.get<double>();
+        if (used.size() != frames || (paging && clock_hand >= frames)) return corrupt(error);
+        this->frames.loadUsedBits(used);
 
-    int getActiveTicks() const {
-        std::lock_guard<std::mutex> lock(mtx);
-        return quantum_cycle_counter * quantum_cycles; // Example: Total quantum cycles * ticks per quantum
-    }
-    
-    void generateProcess(int process_id) {
-        int instructions = min_ins + rand() % (max_ins - min_ins + 1);
-        int core_id = process_id % num_cores;
-        auto process = std::make_shared<Process>(process_id, instructions, core_id);
-        std::lock_guard<std::mutex> lock(mtx);
-        process_queue.push_back(process);
-    }
+        pool_used = in.get<int64_t>();
+        pool.clear();
+        pool_order.clear();
+        uint64_t pooled = in.get<uint64_t>();
+        for (uint64_t i = 0; i < pooled && in.ok(); ++i) {
+            Process* owner = lookup(in.get<int32_t>());
+            int page = in.get<int32_t>();
+            if (!owner || page < 0 || page >= static_cast<int>(owner->page_frame.size())) return corrupt(error);
+            long long key = poolKey(owner->id, page);
+            PooledPage& entry = pool[key];
+            entry.owner = owner;
+            entry.page = page;
+            in.getVector(entry.data, static_cast<uint64_t>(mem_per_frame) * 2);
+            entry.age = pool_order.insert(pool_order.end(), key);
+        }
+        write_queue.clear();
+        uint64_t queued = in.get<uint64_t>();
+        for (uint64_t i = 0; i < queued && in.ok(); ++i) {
+            Process* owner = lookup(in.get<int32_t>());
+            int page = in.get<int32_t>();
+            if (!owner || page < 0 || page >= static_cast<int>(owner->page_frame.size())) return corrupt(error);
+            write_queue.push_back(std::make_pair(owner, page));
+        }
+        long long* counters[] = {&pool_stores, &pool_loads, &pool_rejects, &pool_writebacks, &disk_writes, &disk_reads,
+                                 &compress_nanos, &decompress_nanos, &prefetched, &prefetch_hits, &prefetch_unused,
+                                 &writeback_rescues};
+        for (long long* counter : counters) *counter = in.get<int64_t>();
 
-    void processGenerator() {
-        int process_id = 1;
-        while (generator_running.load()) {
-            generateProcess(process_id++);
-            std::this_thread::sleep_for(std::chrono::seconds(batch_process_freq));
+        for (const auto& entry : processes) {
+            const Process& process = *entry.second;
+            if (!framesValid(process.allocated_frames) || !framesValid(process.cow_frames)) return corrupt(error);
+            // Every mapped page's frame must name this process and page as its owner
+            int mapped = 0;
+            for (size_t page = 0; page < process.page_frame.size(); ++page) {
+                int frame = process.page_frame[page];
+                if (frame < 0) continue;
+                if (!paging || frame >= num_frames || frame_owner[frame] != &process ||
+                    frame_page[frame] != static_cast<int>(page)) {
+                    return corrupt(error);
+                }
+                ++mapped;
+            }
+            if (mapped != process.resident_pages) return corrupt(error);
+            for (int block : process.huge_frames) {
+                if (block < 0 || block >= static_cast<int>(block_used.size())) return corrupt(error);
+            }
         }
+        return in.ok() || corrupt(error);
     }
 
-    void roundRobinExecute() {
-        while (scheduler_running.load()) {
-            std::lock_guard<std::mutex> lock(mtx);
+    // Coarse occupancy map: each cell covers an equal run of frames ('#' full, '+' partial, '.' free).
+    // Reads only the lock-free frame bitmap, so it needs no lock.
+    std::string memoryMap(int cells) const {
+        if (num_frames <= 0 || cells <= 0) return "";
+        cells = std::min(cells, num_frames);
+        std::string map(cells, '.');
+        for (int cell = 0; cell < cells; ++cell) {
+            int first = static_cast<int>(static_cast<long long>(cell) * num_frames / cells);
+            int last = static_cast<int>(static_cast<long long>(cell + 1) * num_frames / cells);
+            int used = 0;
+            for (int frame = first; frame < last; ++frame) {
+                if (!frames.isFree(frame)) ++used;
+            }
+            if (used == last - first) map[cell] = '#';
+            else if (used > 0) map[cell] = '+';
+        }
+        return map;
+    }
 
-            int active_cores = 0;
+private:
+    static const int kFaultRateWindow = 100; // References per fault-rate sample
 
-            for (auto& process : process_queue) {
-                if (!process->in_memory) {
-                    if (memory_manager.allocateMemory(process)) {
-                        std::cout << "Process " << process->id << " loaded into memory.\n";
-                    } else {
-                        continue;  // Skip if memory allocation fails
-                    }
-                }
+    int max_memory, mem_per_frame, num_frames;
+    std::atomic<int> used_memory;
+    FrameAllocator frames;
+    mutable std::recursive_mutex mem_mtx;
+    std::deque<std::shared_ptr<Process>> backing_store;
+    std::atomic<int> committed_frames{0};
+    std::atomic<int> frames_in_use{0};
 
-                if (process->in_memory && !process->finished.load()) {
-                    ++active_cores; // Count this core as active
-                    int cycles_run_in_quantum = process->runQuantum(quantum_cycles);
+    // Huge frames; block_used counts small frames in use per aligned block, or kHugeBlock
+    static const int kHugeBlock = -1;
+    static const int kHugeTlbKey = 1 << 30;
+    int huge_ratio = 0;                   // Small frames per huge frame; 0 when disabled
+    int huge_threshold = 0;
+    bool huge_promote = false;
+    std::vector<int> block_used;
+    int free_blocks = 0, split_blocks = 0;
+    long long huge_fallbacks = 0, huge_promotions = 0;
 
+    // Shared program images for copy-on-write
+    struct SharedImage {
+        std::vector<int> frames;
+        int users = 0;
+    };
+    bool sharing = false;
+    double shared_fraction = 0.0;
+    std::unordered_map<int, SharedImage> images; // By program id
+    std::vector<int> frame_refs;          // References on image frames; 0 for every other frame
+    int image_frames = 0;
+    long long shared_mappings = 0, cow_faults = 0;
 
-                    if (process->finished.load()) {
-                        memory_manager.releaseMemory(process);
-                        finished_processes.push_back(process);
-                    }
-                }
-            }
+    // Demand paging
+    bool paging;
+    unsigned char ws_mask;                // Aging bits that count towards the working set
+    std::vector<Process*> frame_owner;    // Process whose page is in each frame
+    std::vector<int> frame_page;
+    size_t clock_hand = 0;
+    long long total_faults = 0, evictions = 0;
+    int window_faults = 0, window_references = 0;
+    double recent_fault_rate = 0.0;       // Faults per 100 references over the last window
 
-            // Update ticks for active and idle cores
-            int idle_ticks = RoundRobinScheduler::calculateIdleTicks(num_cores, active_cores, quantum_cycles);
-            int active_ticks = RoundRobinScheduler::calculateActiveTicks(active_cores, quantum_cycles);
+    // Compressed swap pool, keyed by poolKey; pool_order holds the keys oldest first
+    struct PooledPage {
+        Process* owner;
+        int page;
+        std::vector<unsigned char> data;
+        std::list<long long>::iterator age;
+    };
+    long long pool_capacity = 0, pool_used = 0; // Bytes; capacity 0 when disabled
+    std::unordered_map<long long, PooledPage> pool;
+    std::list<long long> pool_order;
+    std::vector<unsigned char> page_buffer, compressed_buffer;
+    long long pool_stores = 0, pool_loads = 0, pool_rejects = 0, pool_writebacks = 0;
+    long long disk_writes = 0, disk_reads = 0;
+    long long compress_nanos = 0, decompress_nanos = 0;
 
-            quantum_cycle_counter += quantum_cycles;
+    // Swap I/O stage
+    bool async_writes = false;
+    std::deque<std::pair<Process*, int>> write_queue; // Evicted pages waiting to be written
+    long long prefetched = 0, prefetch_hits = 0, prefetch_unused = 0, writeback_rescues = 0;
 
-            // Remove finished processes from queue
-            process_queue.erase(std::remove_if(process_queue.begin(), process_queue.end(),
-                                            [](std::shared_ptr<Process> p) { return p->finished.load(); }),
-                                process_queue.end());
+    // Takes a frame for page (a free one or the clock's victim, which is swapped out) and
+    // brings the page's contents back from wherever swap holds them
+    PageFault installPage(Process& process, int page, PageEviction* evicted) {
+        // A free frame from this thread's region first; the clock only runs once memory is full
+        int frame = frames.allocate(threadRegion());
+        bool taken = frame >= 0;
+        if (!taken) frame = clockFrame();
+        if (frame_owner[frame]) {
+            Process& owner = *frame_owner[frame];
+            int victim = frame_page[frame];
+            owner.page_frame[victim] = -1;
+            --owner.resident_pages;
+            ++evictions;
+            if (owner.page_bits[victim] & kPagePrefetched) ++prefetch_unused;
+            owner.page_bits[victim] &= ~kPagePrefetched;
+            swapOutPage(owner, victim);
+            if (evicted) {
+                evicted->process_id = owner.id;
+                evicted->page = victim;
+            }
+        } else {
+            if (!taken) frames.claim(frame);
+            used_memory += mem_per_frame;
+            ++frames_in_use;
         }
+        frame_owner[frame] = &process;
+        frame_page[frame] = page;
+        process.page_frame[page] = frame;
+        ++process.resident_pages;
+        return swapInPage(process, page);
     }
 
-
-    
-    void startScheduler() override {
-        scheduler_running.store(true);
-        generator_running.store(true);
-        scheduler_thread = std::thread(&RoundRobinScheduler::roundRobinExecute, this);
-        generator_thread = std::thread(&RoundRobinScheduler::processGenerator, this);
+    static long long poolKey(int process_id, int page) {
+        return (static_cast<long long>(process_id) << 32) | static_cast<unsigned int>(page);
     }
 
-    void stopScheduler() override {
-        generator_running.store(false);
-
-        if (generator_thread.joinable()) {
-            generator_thread.join();
+    // Synthetic contents of a page, the same every time it is swapped: roughly a third are
+    // zero-filled, half hold repetitive records and the rest are random, so the pool sees a
+    // realistic mix of compressible and incompressible pages
+    void fillPage(const Process& process, int page) {
+        unsigned int state = static_cast<unsigned int>(process.id) * 2654435761u ^ static_cast<unsigned int>(page) * 40503u;
+        auto next = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        };
+        if (state == 0) state = 1;
+        unsigned int kind = next() % 10;
+        if (kind < 3) {
+            std::fill(page_buffer.begin(), page_buffer.end(), 0);
+            page_buffer[0] = static_cast<unsigned char>(page);
+            return;
+        }
+        static const char* const kWords[] = {"process ", "running ", "waiting ", "ready   "};
+        for (size_t offset = 0; offset < page_buffer.size(); offset += 16) {
+            for (size_t i = 0; i < 16 && offset + i < page_buffer.size(); ++i) {
+                unsigned char byte;
+                if (kind >= 8) byte = static_cast<unsigned char>(next());
+                else if (i < 4) byte = static_cast<unsigned char>((offset / 16) >> (8 * i)); // Record number
+                else if (i < 8) byte = static_cast<unsigned char>(page);
+                else byte = static_cast<unsigned char>(kWords[(offset / 16 + page) % 4][i - 8]);
+                page_buffer[offset + i] = byte;
+            }
         }
     }
 
-    void displayStatus() override {
-        std::vector<std::shared_ptr<Process>> process_queue_copy;
-        std::vector<std::shared_ptr<Process>> finished_processes_copy;
-        int cores_used, cores_available;
-
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            process_queue_copy = process_queue;
-            finished_processes_copy = finished_processes;
-            cores_used = std::min(static_cast<int>(process_queue_copy.size()), num_cores);
-            cores_available = num_cores - cores_used;
+    void swapOutPage(Process& owner, int page) {
+        if (async_writes) {
+            owner.page_bits[page] |= kPageWriteback;
+            write_queue.push_back(std::make_pair(&owner, page));
+            return;
         }
+        storePage(owner, page);
+    }
 
-        std::cout << "\nCPU utilization: " << (cores_used * 100 / num_cores) << "%\n";
-        std::cout << "Cores used: " << cores_used << "\n";
-        std::cout << "Cores available: " << cores_available << "\n";
-        std::cout << "-------------------------------------------------------------------------\n";
-        std::cout << "Ready Queue (waiting to run in next cycle):\n";
-        for (const auto& process : process_queue_copy) {
-            if (!process->finished && !process->is_running) {
-                std::cout << process->getStatus() << "\n";
+    // Puts an evicted page in the pool if it compresses to at most 3/4 of a frame, writing
+    // the oldest pooled pages back to make room; anything else goes to the backing store.
+    // Returns true if the page itself went to the backing store.
+    bool storePage(Process& owner, int page) {
+        if (pool_capacity > 0) {
+            fillPage(owner, page);
+            auto start = std::chrono::steady_clock::now();
+            size_t size = lzCompress(page_buffer.data(), page_buffer.size(), compressed_buffer);
+            compress_nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (size <= page_buffer.size() * 3 / 4) {
+                while (pool_used + static_cast<long long>(size) > pool_capacity && !pool_order.empty()) {
+                    auto oldest = pool.find(pool_order.front());
+                    oldest->second.owner->page_bits[oldest->second.page] |= kPageOnDisk;
+                    ++disk_writes;
+                    ++pool_writebacks;
+                    dropPooled(oldest);
+                }
+                long long key = poolKey(owner.id, page);
+                PooledPage& entry = pool[key];
+                entry.owner = &owner;
+                entry.page = page;
+                entry.data.assign(compressed_buffer.begin(), compressed_buffer.end());
+                entry.age = pool_order.insert(pool_order.end(), key);
+                pool_used += static_cast<long long>(size);
+                ++pool_stores;
+                return false;
             }
+            ++pool_rejects;
         }
-        std::cout << "-------------------------------------------------------------------------\n";
-        std::cout << "Running Processes (currently active in quantum cycle):\n";
-        for (const auto& process : process_queue_copy) {
-            if (process->is_running && !process->finished) {
-                std::cout << process->getStatus() << "\n";
-            }
+        owner.page_bits[page] |= kPageOnDisk;
+        ++disk_writes;
+        return true;
+    }
+
+    // Brings a faulting page's contents back from the write-back queue, the pool or the backing store
+    PageFault swapInPage(Process& process, int page) {
+        if (process.page_bits[page] & kPageWriteback) {
+            process.page_bits[page] &= ~kPageWriteback; // Its queued write is skipped
+            ++writeback_rescues;
+            return PageFault::Minor;
         }
-        std::cout << "-------------------------------------------------------------------------\n";
-        std::cout << "Finished Processes:\n";
-        for (const auto& process : finished_processes_copy) {
-            std::cout << process->getStatus() << "\n";
+        auto entry = pool.find(poolKey(process.id, page));
+        if (entry != pool.end()) {
+            const std::vector<unsigned char>& data = entry->second.data;
+            auto start = std::chrono::steady_clock::now();
+            bool expanded = lzDecompress(data.data(), data.size(), page_buffer.data(), page_buffer.size());
+            decompress_nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            dropPooled(entry);
+            if (expanded) {
+                ++pool_loads;
+                return PageFault::Compressed;
+            }
         }
+        if (process.page_bits[page] & kPageOnDisk) ++disk_reads;
+        return PageFault::Major;
     }
 
-    void generateUtilizationReport() override {
-        std::ofstream report_file("csopesy-log.txt");
-
-        std::vector<std::shared_ptr<Process>> process_queue_copy;
-        std::vector<std::shared_ptr<Process>> finished_processes_copy;
-        int cores_used, cores_available;
+    void dropPooled(std::unordered_map<long long, PooledPage>::iterator entry) {
+        pool_used -= static_cast<long long>(entry->second.data.size());
+        pool_order.erase(entry->second.age);
+        pool.erase(entry);
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            process_queue_copy = process_queue;
-            finished_processes_copy = finished_processes;
-            cores_used = process_queue_copy.size();
-            cores_available = num_cores - cores_used;
+    bool framesValid(const std::vector<int>& frames) const {
+        for (int frame : frames) {
+            if (frame < 0 || frame >= num_frames) return false;
         }
+        return true;
+    }
 
-        // Process Summary (similar to `process-smi`)
-        report_file << "CPU utilization: " << (cores_used * 100 / num_cores) << "%\n";
-        report_file << "Cores used: " << cores_used << "\n";
-        report_file << "Cores available: " << cores_available << "\n";
-        report_file << "-------------------------------------------------------------------------\n";
+    static bool corrupt(std::string& error) {
+        error = "the checkpoint's memory state is inconsistent";
+        return false;
+    }
 
-        // Detailed Memory/CPU Stats (similar to `vmstat`)
-        int max_memory = memory_manager.getAvailableMemory();
-        int total_memory = max_memory;
-        int active_cpu_ticks = cores_used * 1000;  // Placeholder for actual CPU tick calculation
-        int idle_cpu_ticks = (num_cores - cores_used) * 1000;  // Placeholder
+    void commit(Process& process, int frames) {
+        committed_frames += frames - process.committed_frames;
+        process.committed_frames = frames;
+    }
 
-        report_file << "Total memory: " << total_memory << " KB\n";
-        report_file << "Used memory: " << (total_memory - max_memory) << " KB\n";
-        report_file << "Free memory: " << max_memory << " KB\n";
-        report_file << "Idle CPU ticks: " << idle_cpu_ticks << "\n";
-        report_file << "Active CPU ticks: " << active_cpu_ticks << "\n";
-        report_file << "-------------------------------------------------------------------------\n";
-        report_file << "Processes in memory:\n";
-        for (const auto& process : process_queue_copy) {
-            report_file << process->getStatus() << "\n";
+    // Next frame for a faulting page: a free one, or a victim whose reference bit is clear.
+    // Referenced pages get a second chance; after one full sweep every bit is clear.
+    int clockFrame() {
+        while (true) {
+            size_t frame = clock_hand;
+            clock_hand = (clock_hand + 1) % num_frames;
+            Process* owner = frame_owner[frame];
+            if (!owner) return static_cast<int>(frame);
+            unsigned char& bits = owner->page_bits[frame_page[frame]];
+            if (bits & kPageReferenced) {
+                bits &= ~kPageReferenced;
+            } else {
+                return static_cast<int>(frame);
+            }
         }
-
-        report_file.close();
-        std::cout << "CPU utilization report has been saved to csopesy-log.txt\n";
     }
 
-};
-
-void readConfig(int &num_cpu, std::string &scheduler_type, unsigned int &quantum_cycles,
-                unsigned int &batch_process_freq, unsigned int &min_ins, unsigned int &max_ins,
-                unsigned int &delays_per_exec, int &max_mem, int &mem_per_frame, int &min_mem_proc, int &max_mem_proc, bool &use_paging) {
-    num_cpu = -1;
-    scheduler_type = "";
-    quantum_cycles = 0;
-    batch_process_freq = 0;
-    min_ins = 0;
-    max_ins = 0;
-    delays_per_exec = 0;
-    max_mem = 0;
-    mem_per_frame = 0;
-    min_mem_proc = 0;
-    max_mem_proc = 0;
-    use_paging = false;
-
-    std::ifstream file("config.txt");
-    std::string key;
-    while (file >> key) {
-        if (key == "num-cpu") file >> num_cpu;
-        else if (key == "scheduler") file >> scheduler_type;
-        else if (key == "quantum-cycles") file >> quantum_cycles;
-        else if (key == "batch-process-freq") file >> batch_process_freq;
-        else if (key == "min-ins") file >> min_ins;
-        else if (key == "max-ins") file >> max_ins;
-        else if (key == "delays-per-exec") file >> delays_per_exec;
-        else if (key == "max-overall-mem") file >> max_mem;
-        else if (key == "mem-per-frame") file >> mem_per_frame;
-        else if (key == "min-mem-per-proc") file >> min_mem_proc;
-        else if (key == "max-mem-per-proc") file >> max_mem_proc;
-        else if (key == "paging") file >> use_paging;
+    void allocateFrames(std::shared_ptr<Process> process, int frames_needed) {
+        process->allocated_frames.clear();
+        takeFrames(frames_needed, process->allocated_frames); // Also updates used_memory
+        process->in_memory = true;
+    }
+
+    // Appends count free small frames to out, from the calling thread's region first; false,
+    // with nothing taken, if there were not enough. Needs no lock: a racing caller that empties
+    // the allocator first just makes this one hand its frames back.
+    bool takeFrames(int count, std::vector<int>& out) {
+        if (count <= 0) return true;
+        if (frames.freeFrames() < count) return false;
+        size_t start = out.size();
+        int region = threadRegion();
+        for (int taken = 0; taken < count; ++taken) {
+            int frame = frames.allocate(region);
+            if (frame < 0) {
+                for (size_t i = start; i < out.size(); ++i) frames.release(out[i]);
+                out.resize(start);
+                return false;
+            }
+            out.push_back(frame);
+        }
+        used_memory += count * mem_per_frame;
+        frames_in_use += count;
+        for (size_t i = start; i < out.size(); ++i) claimSmallFrame(out[i]);
+        return true;
+    }
+
+    // No paging, huge frames or sharing: a process is just a list of frames, so admission and
+    // release go straight to the allocator without mem_mtx
+    bool plainFrames() const {
+        return !paging && huge_ratio == 0 && !sharing;
+    }
+
+    bool allocatePlain(Process& process) {
+        int frames_needed = framesFor(process);
+        std::vector<int> taken;
+        if (!takeFrames(frames_needed, taken)) return false;
+        process.allocated_frames.swap(taken);
+        commit(process, frames_needed);
+        process.in_memory = true;
+        return true;
+    }
+
+    void releasePlain(Process& process) {
+        for (int frame : process.allocated_frames) frames.release(frame);
+        used_memory -= static_cast<int>(process.allocated_frames.size()) * mem_per_frame;
+        frames_in_use -= static_cast<int>(process.allocated_frames.size());
+        process.allocated_frames.clear();
+        commit(process, 0);
+        process.in_memory = false;
+    }
+
+    static int& threadRegion() {
+        static thread_local int region = 0;
+        return region;
+    }
+
+    void layoutSharedPages(Process& process) {
+        process.shared_pages = 0;
+        process.code_pages = 0;
+        if (!sharing || process.program < 0) return;
+        int shared = static_cast<int>(framesFor(process) * shared_fraction);
+        auto image = images.find(process.program);
+        if (image != images.end() && static_cast<int>(image->second.frames.size()) != shared) {
+            return; // Same program id from before a config reload, but a different size
+        }
+        process.shared_pages = shared;
+        process.code_pages = shared / 2;
+    }
+
+    // Maps the program's image, loading it first if this is its only user. The image holds
+    // one reference on each frame and every mapping holds another.
+    void mapSharedImage(Process& process) {
+        SharedImage& image = images[process.program];
+        if (image.frames.empty()) {
+            takeFrames(process.shared_pages, image.frames);
+            for (int frame : image.frames) frame_refs[frame] = 1;
+            image_frames += process.shared_pages;
+            committed_frames += process.shared_pages;
+        }
+        ++image.users;
+        process.cow_frames = image.frames;
+        for (int frame : image.frames) ++frame_refs[frame];
+        process.shared_mapped = process.shared_pages;
+        shared_mappings += process.shared_pages;
+    }
+
+    void unmapSharedImage(Process& process) {
+        if (process.cow_frames.empty()) return;
+        for (int frame : process.cow_frames) {
+            if (frame_refs[frame] > 0) --frame_refs[frame]; // Private copies were freed with allocated_frames
+        }
+        shared_mappings -= process.shared_mapped;
+        process.shared_mapped = 0;
+        process.cow_frames.clear();
+
+        auto image = images.find(process.program);
+        if (image != images.end() && --image->second.users == 0) {
+            for (int frame : image->second.frames) {
+                frame_refs[frame] = 0;
+                frames.release(frame);
+                releaseSmallFrame(frame);
+                --frames_in_use;
+                used_memory -= mem_per_frame;
+            }
+            image_frames -= static_cast<int>(image->second.frames.size());
+            committed_frames -= static_cast<int>(image->second.frames.size());
+            images.erase(image);
+        }
+    }
+
+    // Takes up to count entirely free blocks as huge frames; returns how many it got
+    int allocateHugeFrames(Process& process, int count) {
+        int got = 0;
+        for (size_t block = 0; block < block_used.size() && got < count && free_blocks > 0; ++block) {
+            if (block_used[block] != 0) continue;
+            int first = static_cast<int>(block) * huge_ratio;
+            for (int frame = first; frame < first + huge_ratio; ++frame) frames.claim(frame);
+            block_used[block] = kHugeBlock;
+            --free_blocks;
+            frames_in_use += huge_ratio;
+            used_memory += huge_ratio * mem_per_frame;
+            process.huge_frames.push_back(static_cast<int>(block));
+            ++got;
+        }
+        return got;
+    }
+
+    void releaseBlock(int block) {
+        int first = block * huge_ratio;
+        for (int frame = first; frame < first + huge_ratio; ++frame) frames.release(frame);
+        block_used[block] = 0;
+        ++free_blocks;
+        frames_in_use -= huge_ratio;
+        used_memory -= huge_ratio * mem_per_frame;
+    }
+
+    // Small-frame bookkeeping per block; the first small frame taken from a free block splits it
+    void claimSmallFrame(int frame) {
+        if (huge_ratio == 0) return;
+        size_t block = frame / huge_ratio;
+        if (block >= block_used.size()) return;
+        if (block_used[block]++ == 0) {
+            --free_blocks;
+            ++split_blocks;
+        }
+    }
+
+    void releaseSmallFrame(int frame) {
+        if (huge_ratio == 0) return;
+        size_t block = frame / huge_ratio;
+        if (block >= block_used.size()) return;
+        if (--block_used[block] == 0) {
+            ++free_blocks;
+            --split_blocks;
+        }
+    }
+
+};
+
+// Function prototypes for commands
+void processSMI(const MemorySnapshot& memory, const std::vector<ProcessSnapshot>& processes, std::ostream& out);
+void vmStat(const SchedulerSnapshot& snapshot, std::ostream& out);
+
+// Other parts of the program remain unchanged from your provided code.
+// Add or integrate these functions as required.
+
+
+class Scheduler {
+public:
+    virtual void startScheduler() = 0;
+    virtual void stopScheduler() = 0;
+    virtual void displayStatus(std::ostream& out) = 0;
+    virtual void generateUtilizationReport(std::ostream& out) = 0;
+    virtual ~Scheduler() = default;
+};
+
+
+// Dispatch order for one core's ready processes. The scheduler calls these with its mtx held.
+class ReadyQueue {
+public:
+    virtual ~ReadyQueue() = default;
+    virtual void push(const std::shared_ptr<Process>& process) = 0;
+    virtual std::shared_ptr<Process> pop() = 0; // nullptr when empty
+    virtual std::shared_ptr<Process> peek() const = 0; // What pop would return, left in place
+    virtual size_t size() const = 0;
+    virtual void drainTo(std::vector<std::shared_ptr<Process>>& out) = 0; // Removes every queued process
+
+    // Visits every queued process in drainTo's order without touching the queue
+    virtual void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const = 0;
+
+    // A process read back from a checkpoint; unlike push it keeps the saved queueing state
+    virtual void restore(const std::shared_ptr<Process>& process) {
+        push(process);
+    }
+
+    // Takes a specific process out (e.g. to swap it out); false if it is not queued here
+    virtual bool remove(const std::shared_ptr<Process>& process) = 0;
+
+    // Hands a process to an idle core; nullptr when empty. Defaults to the next one in order.
+    virtual std::shared_ptr<Process> steal() {
+        return pop();
+    }
+
+    // A process that ran for cycles_used ticks and is not finished goes back through here
+    virtual void requeue(const std::shared_ptr<Process>& process, int /*cycles_used*/, bool /*quantum_expired*/) {
+        push(process);
+    }
+    virtual int quantumFor(const Process& /*process*/, int default_quantum) const {
+        return default_quantum;
+    }
+    virtual void advanceClock(long long /*now*/) {} // now = ticks elapsed on the owning core
+
+    // The process's priority changed while it may be queued here
+    virtual void reprioritize(const std::shared_ptr<Process>& /*process*/) {}
+
+    // Polled by the core worker between instructions WITHOUT mtx held, so overrides may only
+    // read state that is safe to read concurrently (atomics)
+    virtual bool shouldPreempt(const Process& /*running*/) const {
+        return false;
+    }
+};
+
+typedef std::function<std::unique_ptr<ReadyQueue>()> ReadyQueueFactory;
+
+// Plain round robin order
+class FifoReadyQueue : public ReadyQueue {
+    std::deque<std::shared_ptr<Process>> queue;
+
+public:
+    void push(const std::shared_ptr<Process>& process) override {
+        queue.push_back(process);
+    }
+
+    std::shared_ptr<Process> pop() override {
+        if (queue.empty()) return nullptr;
+        std::shared_ptr<Process> process = queue.front();
+        queue.pop_front();
+        return process;
+    }
+
+    std::shared_ptr<Process> peek() const override {
+        return queue.empty() ? nullptr : queue.front();
+    }
+
+    size_t size() const override {
+        return queue.size();
+    }
+
+    void drainTo(std::vector<std::shared_ptr<Process>>& out) override {
+        out.insert(out.end(), queue.begin(), queue.end());
+        queue.clear();
+    }
+
+    void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const override {
+        for (const auto& process : queue) visit(process);
+    }
+
+    bool remove(const std::shared_ptr<Process>& process) override {
+        auto it = std::find(queue.begin(), queue.end(), process);
+        if (it == queue.end()) return false;
+        queue.erase(it);
+        return true;
+    }
+
+    // The newest arrival is the least likely to still be warm on this core
+    std::shared_ptr<Process> steal() override {
+        if (queue.empty()) return nullptr;
+        std::shared_ptr<Process> process = queue.back();
+        queue.pop_back();
+        return process;
+    }
+};
+
+// First come, first served: FIFO order and each dispatch runs the process to completion
+class FcfsReadyQueue : public FifoReadyQueue {
+public:
+    int quantumFor(const Process& process, int /*default_quantum*/) const override {
+        return process.remaining();
+    }
+};
+
+struct HeapSlot {
+    int& operator()(const std::shared_ptr<Process>& process) const {
+        return process->heap_index;
+    }
+};
+typedef IndexedHeap<std::shared_ptr<Process>, HeapSlot, 2> ProcessHeap;
+
+// Preemptive shortest remaining time first. The heap is keyed on remaining instructions; the
+// running process is off the heap, so its shrinking remaining time costs nothing while it runs,
+// and a newly queued shorter process preempts it at the next instruction boundary.
+class SrtfReadyQueue : public ReadyQueue {
+    ProcessHeap heap;
+    std::atomic<long long> shortest_waiting{LLONG_MAX}; // Read lock-free by shouldPreempt
+
+    void publishShortest() {
+        shortest_waiting.store(heap.empty() ? LLONG_MAX : heap.topKey(), std::memory_order_relaxed);
+    }
+
+public:
+    void push(const std::shared_ptr<Process>& process) override {
+        if (heap.contains(process)) {
+            heap.update(process, process->remaining());
+        } else {
+            heap.push(process, process->remaining());
+        }
+        publishShortest();
+    }
+
+    std::shared_ptr<Process> pop() override {
+        if (heap.empty()) return nullptr;
+        std::shared_ptr<Process> process = heap.pop();
+        publishShortest();
+        return process;
+    }
+
+    std::shared_ptr<Process> peek() const override {
+        return heap.empty() ? nullptr : heap.top();
+    }
+
+    size_t size() const override {
+        return heap.size();
+    }
+
+    void drainTo(std::vector<std::shared_ptr<Process>>& out) override {
+        heap.drainTo(out);
+        publishShortest();
+    }
+
+    void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const override {
+        heap.forEach([&visit](const std::shared_ptr<Process>& process, long long) { visit(process); });
+    }
+
+    bool remove(const std::shared_ptr<Process>& process) override {
+        if (!heap.contains(process)) return false;
+        heap.erase(process);
+        publishShortest();
+        return true;
+    }
+
+    int quantumFor(const Process& process, int /*default_quantum*/) const override {
+        return process.remaining();
+    }
+
+    bool shouldPreempt(const Process& running) const override {
+        return shortest_waiting.load(std::memory_order_relaxed) < running.remaining();
+    }
+};
+
+typedef IndexedHeap<std::shared_ptr<Process>, HeapSlot, 4> PriorityHeap;
+
+// Preemptive priority order with aging, on a 4-ary heap (shallower than a binary heap, so
+// fewer cache misses per sift). A process's key is the core clock when it was queued plus
+// priority * aging_ticks, which orders processes by priority minus the aging levels they have
+// waited: every aging_ticks spent waiting is worth one level, so no key is ever rewritten as
+// time passes and renice is a single O(log n) update. With aging off the key is the priority.
+// Equal keys run round robin.
+class PriorityReadyQueue : public ReadyQueue {
+    PriorityHeap heap;
+    long long aging_ticks;
+    long long clock = 0;
+    std::atomic<int> best_waiting{INT_MAX}; // Effective priority of the top process, read by shouldPreempt
+
+    long long keyFor(const Process& process) const {
+        return aging_ticks > 0 ? process.queued_at + process.priority.load() * aging_ticks : process.priority.load();
+    }
+
+    void publishBest() {
+        int best = INT_MAX;
+        if (!heap.empty()) {
+            best = static_cast<int>(aging_ticks > 0 ? (heap.topKey() - clock) / aging_ticks : heap.topKey());
+        }
+        best_waiting.store(best, std::memory_order_relaxed);
+    }
+
+public:
+    explicit PriorityReadyQueue(long long aging_ticks) : aging_ticks(std::max(0LL, aging_ticks)) {}
+
+    void push(const std::shared_ptr<Process>& process) override {
+        process->queued_at = clock;
+        if (heap.contains(process)) {
+            heap.update(process, keyFor(*process));
+        } else {
+            heap.push(process, keyFor(*process));
+        }
+        publishBest();
+    }
+
+    std::shared_ptr<Process> pop() override {
+        if (heap.empty()) return nullptr;
+        std::shared_ptr<Process> process = heap.pop();
+        publishBest();
+        return process;
+    }
+
+    std::shared_ptr<Process> peek() const override {
+        return heap.empty() ? nullptr : heap.top();
+    }
+
+    size_t size() const override {
+        return heap.size();
+    }
+
+    void drainTo(std::vector<std::shared_ptr<Process>>& out) override {
+        heap.drainTo(out);
+        publishBest();
+    }
+
+    void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const override {
+        heap.forEach([&visit](const std::shared_ptr<Process>& process, long long) { visit(process); });
+    }
+
+    // The saved queued_at still counts, so a restored process keeps the aging it had earned
+    void restore(const std::shared_ptr<Process>& process) override {
+        if (heap.contains(process)) {
+            heap.update(process, keyFor(*process));
+        } else {
+            heap.push(process, keyFor(*process));
+        }
+        publishBest();
+    }
+
+    bool remove(const std::shared_ptr<Process>& process) override {
+        if (!heap.contains(process)) return false;
+        heap.erase(process);
+        publishBest();
+        return true;
+    }
+
+    // Keeps the time already waited; only the priority part of the key changes
+    void reprioritize(const std::shared_ptr<Process>& process) override {
+        if (!heap.contains(process)) return;
+        heap.update(process, keyFor(*process));
+        publishBest();
+    }
+
+    void advanceClock(long long now) override {
+        clock = now;
+        publishBest();
+    }
+
+    // A waiting process more urgent than the running one, counting its aging, takes the core
+    bool shouldPreempt(const Process& running) const override {
+        return best_waiting.load(std::memory_order_relaxed) < running.priority.load(std::memory_order_relaxed);
+    }
+};
+
+// Earliest deadline first for real-time processes, in front of the scheduler's own queue for
+// everything else. Real-time work always runs first and a newly queued earlier deadline
+// preempts the running process, real-time or not; the utilization test at admission is what
+// leaves the other queue its share. Real-time processes are partitioned: they are never
+// stolen, since their utilization is reserved on this core.
+class DeadlineReadyQueue : public ReadyQueue {
+    ProcessHeap deadlines;
+    std::unique_ptr<ReadyQueue> fair;
+    std::atomic<long long> earliest{LLONG_MAX}; // Read lock-free by shouldPreempt
+
+    void publishEarliest() {
+        earliest.store(deadlines.empty() ? LLONG_MAX : deadlines.topKey(), std::memory_order_relaxed);
+    }
+
+public:
+    explicit DeadlineReadyQueue(std::unique_ptr<ReadyQueue> fair) : fair(std::move(fair)) {}
+
+    void push(const std::shared_ptr<Process>& process) override {
+        if (!process->realtime) {
+            fair->push(process);
+            return;
+        }
+        if (deadlines.contains(process)) {
+            deadlines.update(process, process->deadlineKey());
+        } else {
+            deadlines.push(process, process->deadlineKey());
+        }
+        publishEarliest();
+    }
+
+    std::shared_ptr<Process> pop() override {
+        if (deadlines.empty()) return fair->pop();
+        std::shared_ptr<Process> process = deadlines.pop();
+        publishEarliest();
+        return process;
+    }
+
+    std::shared_ptr<Process> peek() const override {
+        return deadlines.empty() ? fair->peek() : deadlines.top();
+    }
+
+    size_t size() const override {
+        return deadlines.size() + fair->size();
+    }
+
+    void drainTo(std::vector<std::shared_ptr<Process>>& out) override {
+        deadlines.drainTo(out);
+        publishEarliest();
+        fair->drainTo(out);
+    }
+
+    void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const override {
+        deadlines.forEach([&visit](const std::shared_ptr<Process>& process, long long) { visit(process); });
+        fair->forEach(visit);
+    }
+
+    void restore(const std::shared_ptr<Process>& process) override {
+        if (process->realtime) {
+            push(process);
+        } else {
+            fair->restore(process);
+        }
+    }
+
+    bool remove(const std::shared_ptr<Process>& process) override {
+        if (!process->realtime) return fair->remove(process);
+        if (!deadlines.contains(process)) return false;
+        deadlines.erase(process);
+        publishEarliest();
+        return true;
+    }
+
+    std::shared_ptr<Process> steal() override {
+        return fair->steal();
+    }
+
+    void requeue(const std::shared_ptr<Process>& process, int cycles_used, bool quantum_expired) override {
+        if (process->realtime) {
+            push(process);
+        } else {
+            fair->requeue(process, cycles_used, quantum_expired);
+        }
+    }
+
+    // A real-time process runs until it finishes or an earlier deadline arrives
+    int quantumFor(const Process& process, int default_quantum) const override {
+        return process.realtime ? process.remaining() : fair->quantumFor(process, default_quantum);
+    }
+
+    void advanceClock(long long now) override {
+        fair->advanceClock(now);
+    }
+
+    void reprioritize(const std::shared_ptr<Process>& process) override {
+        if (!process->realtime) fair->reprioritize(process);
+    }
+
+    bool shouldPreempt(const Process& running) const override {
+        long long first = earliest.load(std::memory_order_relaxed);
+        if (running.realtime) return first < running.deadlineKey();
+        return first != LLONG_MAX || fair->shouldPreempt(running);
+    }
+};
+
+const int kSnapshotIntervalMs = 100;     // How often the scheduler publishes a SchedulerSnapshot
+const size_t kSnapshotTopProcesses = 64; // Processes kept in a snapshot's top list
+
+// Section tags of a scheduler checkpoint, in the order they are written
+const uint32_t kCheckpointScheduler = 1;
+const uint32_t kCheckpointProcesses = 2;
+const uint32_t kCheckpointQueues = 3;
+const uint32_t kCheckpointStats = 4;
+const uint32_t kCheckpointMemory = 5;
+const uint32_t kCheckpointEnd = 6;
+
+class RoundRobinScheduler : public Scheduler, public ClusterHost {
+protected:
+    ConfigManager& config;
+    std::atomic<int> quantum_cycles, batch_process_freq, num_cores;
+    WorkloadGenerator workload;
+    std::mutex workload_mtx; // Guards workload while a reload swaps it
+    std::atomic<int> next_process_id{1}; // Also taken by processes adopted from other nodes
+    std::atomic<bool> scheduler_running{false};
+    std::atomic<bool> generator_running{false};
+    mutable std::mutex mtx; // Make sure it's mutable if accessed by const methods.
+    std::mutex reconfigure_mtx; // Serializes start and config reloads
+    std::condition_variable ready_cv;
+    std::thread generator_thread, watcher_thread;
+    std::thread snapshot_thread;
+    std::vector<std::thread> core_threads; // One worker per simulated core
+
+    // Simulated costs of putting a process on a core, in ticks
+    struct DispatchCosts {
+        int context_switch = 0;
+        int migration = 0;
+        int cache_reload = 0;
+        long long cache_warm = 0; // Ticks of other work a core can run before a process's cache goes cold
+        bool steal = true;
+        size_t steal_min_queue = 2;
+        int tlb_entries = 0;
+        int tlb_ways = 4;
+        bool tlb_asid = true;
+        int tlb_miss = 1;
+    };
+    struct DispatchStats {
+        long long switches = 0, switch_ticks = 0;
+        long long migrations = 0, migration_ticks = 0;
+        long long cold_dispatches = 0, reload_ticks = 0;
+        long long warm_dispatches = 0;
+        long long steals = 0;
+        long long tlb_miss_ticks = 0;
+    };
+    // Per-core scheduling state. With pin-cores the pinned worker re-creates its own CoreState,
+    // so first-touch allocation places the queue on that CPU's NUMA node.
+    struct CoreState {
+        std::unique_ptr<ReadyQueue> ready_queue; // Processes whose home core is this one
+        std::shared_ptr<Process> current; // Process running on this core, if any
+        long long active_ticks = 0;
+        long long idle_ticks = 0;
+        QuantumController tuner; // Quantum handed to the ready queue for each dispatch
+        int last_process_id = -1; // Process whose state is loaded on this core
+        DispatchStats stats;
+        Tlb tlb;
+        mutable std::mutex tlb_mtx; // Guards tlb: its owner looks up without mtx, others shoot down
+    };
+    std::vector<std::unique_ptr<CoreState>> cores; // Guarded by mtx; never shrinks
+    ReadyQueueFactory ready_queue_factory;
+    QuantumTuning quantum_tuning; // Guarded by mtx
+    DispatchCosts costs;          // Guarded by mtx
+    bool pin_cores;
+    int pin_cpu_offset;
+    std::vector<int> host_cpus; // Host CPUs available for pinning
+
+    // Latest published snapshot; swapped with std::atomic_store so readers never take mtx
+    std::shared_ptr<const SchedulerSnapshot> latest_snapshot;
+    unsigned long long snapshot_sequence = 0;
+    std::vector<std::shared_ptr<Process>> process_queue, finished_processes;
+    LatencyHistogram turnaround_latency, waiting_latency, response_latency; // Finished processes, in ticks
+    std::map<int, PriorityLatency> priority_latency; // The same, split by priority
+    ProcessIndex<std::shared_ptr<Process>> process_index; // Name/PID lookup over running and finished processes
+    MemoryManager memory_manager;
+    int quantum_cycle_counter = 0;
+
+    // Medium-term admission. Pending processes are indexed both by memory need, to find the
+    // largest one that fits a hole, and by arrival, so the oldest can hold a reservation.
+    struct AdmissionPolicy {
+        int max_bypass = 8;
+        bool swap_out = true;
+        long long swap_min_idle = 10; // Ticks
+        int page_fault_ticks = 1;
+        double thrash_fault_rate = 20; // Faults per 100 references
+        double write_ratio = 0.3;
+        int cow_fault_ticks = 1;
+        int zswap_load_ticks = 0;
+        int swap_prefetch = 2;
+    };
+    struct AdmissionStats {
+        long long admitted = 0, backfilled = 0, swapped_out = 0, swapped_in = 0;
+        long long suspended = 0; // Swapped out by thrash control
+    };
+    AdmissionPolicy admission;    // Guarded by mtx
+    AdmissionStats admission_stats;
+    std::map<std::pair<int, unsigned long long>, std::shared_ptr<Process>> pending_by_size; // (frames, seq)
+    std::map<unsigned long long, std::shared_ptr<Process>> pending_by_age;
+    unsigned long long pending_sequence = 0;
+
+    // Swap I/O stage (async-swap, fixed at startup): processes parked on a page-in, and pages
+    // to read ahead; queued write-backs live in the memory manager. All guarded by mtx.
+    struct SwapIoStats {
+        long long page_ins = 0;
+        long long stall_ticks_avoided = 0; // Core ticks not spent waiting on page-ins
+        long long depth_samples = 0, depth_total = 0;
+        size_t peak_depth = 0;
+    };
+    static const size_t kMaxQueuedPrefetches = 64;
+    const bool async_swap;
+    std::thread swap_thread;
+    std::condition_variable swap_cv;
+    std::deque<std::shared_ptr<Process>> swap_reads;
+    std::deque<std::pair<std::shared_ptr<Process>, int>> swap_prefetches;
+    SwapIoStats swap_io;
+
+    // EDF class, guarded by mtx. A core's reservation is the summed density (instructions /
+    // relative deadline) of the live real-time processes homed on it.
+    double rt_cap;
+    std::vector<double> rt_reserved;
+    RealTimeStats realtime_stats;
+
+    // Cluster mode: the node serves cluster-socket, the coordinator runs when cluster-peers is set
+    ClusterNode cluster_node;
+    ClusterCoordinator cluster;
+    std::string node_name;
+    std::vector<std::shared_ptr<Process>> migrated_processes; // Left for another node; kept so raw pointers stay valid
+    long long migrated_in = 0, migrated_out = 0;             // Guarded by mtx
+
+    MetricsExporter metrics_exporter; // Rewrites metrics-file from published snapshots
+    ReportWriter report_writer;       // Writes report-util output off the command thread
+
+public:
+    // Subclasses change the dispatch policy by passing their own ReadyQueue factory
+    explicit RoundRobinScheduler(ConfigManager& config, ReadyQueueFactory factory = ReadyQueueFactory())
+        : config(config), quantum_cycles(config.getQuantumCycles()), batch_process_freq(config.getBatchProcessFreq()),
+          num_cores(config.getNumCPUs()),
+          workload(config.getWorkloadSettings(), config.getMinInstructions(), config.getMaxInstructions(),
+                   config.getMinMemPerProc(), config.getMaxMemPerProc()),
+          ready_queue_factory(withDeadlines(factory ? factory : []() { return std::unique_ptr<ReadyQueue>(new FifoReadyQueue()); })),
+          quantum_tuning(config.getQuantumTuning()), costs(readDispatchCosts(config)),
+          pin_cores(config.pinCores()), pin_cpu_offset(config.getPinCpuOffset()), host_cpus(allowedHostCpus()),
+          memory_manager(config.getMaxOverallMemory(), config.getMemPerFrame(), config.usePaging(),
+                         config.getWorkingSetWindow()),
+          admission(readAdmissionPolicy(config)), async_swap(config.usePaging() && config.asyncSwap()),
+          rt_cap(config.getRtUtilizationCap()) {
+        memory_manager.enableCompressedSwap(config.getZswapPoolSize());
+        memory_manager.setAsyncSwap(async_swap);
+        memory_manager.enableHugeFrames(config.getHugeFrameSize(), config.getHugeFrameThreshold(), config.hugePromote());
+        if (config.getWorkloadSettings().programs > 0) {
+            memory_manager.enableSharing(config.getShareFraction());
+        }
+        addCoreStates(config.getNumCPUs());
+        report_writer.setRotation(config.getReportMaxBytes(), config.getReportKeepFiles());
+    }
+
+    ~RoundRobinScheduler() override {
+        cluster.stop();          // The cluster threads and the two below all read from this
+        cluster_node.stop();     // object, so they go first
+        metrics_exporter.stop();
+        report_writer.finish();
+        generator_running.store(false);
+        scheduler_running.store(false);
+        ready_cv.notify_all();
+        swap_cv.notify_all();
+        if (generator_thread.joinable()) generator_thread.join();
+        if (swap_thread.joinable()) swap_thread.join();
+        if (watcher_thread.joinable()) watcher_thread.join();
+        if (snapshot_thread.joinable()) snapshot_thread.join();
+        for (auto& worker : core_threads) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    // Switch/migration/cache counts and the ticks they cost, summed over all cores
+    void writeDispatchStats(std::ostream& out) const {
+        DispatchStats total;
+        long long active = 0;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto& core : cores) {
+                total.switches += core->stats.switches;
+                total.switch_ticks += core->stats.switch_ticks;
+                total.migrations += core->stats.migrations;
+                total.migration_ticks += core->stats.migration_ticks;
+                total.cold_dispatches += core->stats.cold_dispatches;
+                total.warm_dispatches += core->stats.warm_dispatches;
+                total.reload_ticks += core->stats.reload_ticks;
+                total.steals += core->stats.steals;
+                active += core->active_ticks;
+            }
+        }
+        long long lost = total.switch_ticks + total.migration_ticks + total.reload_ticks;
+        long long dispatches = total.warm_dispatches + total.cold_dispatches;
+        out << "Context switches: " << total.switches << " (" << total.switch_ticks << " ticks lost)\n";
+        out << "Migrations: " << total.migrations << " (" << total.migration_ticks << " ticks lost), "
+            << total.steals << " steals\n";
+        out << "Warm dispatches: " << total.warm_dispatches << " / " << dispatches
+            << ", cache reloads cost " << total.reload_ticks << " ticks\n";
+        out << "Dispatch overhead: " << (active + lost > 0 ? lost * 100 / (active + lost) : 0) << "% of busy time\n";
+    }
+
+    void writeAdmissionStats(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        int total = memory_manager.totalFrames();
+        int used = total - memory_manager.availableFrames();
+        out << "Frames in use: " << used << " / " << total << " (" << (total > 0 ? used * 100 / total : 0) << "%)\n";
+        out << "Pending admission: " << pending_by_age.size();
+        if (!pending_by_age.empty()) {
+            const Process& oldest = *pending_by_age.begin()->second;
+            out << " (oldest: process " << oldest.id << ", needs " << oldest.pending_frames
+                << " frames, bypassed " << oldest.bypassed << "x)";
+        }
+        out << "\n";
+        out << "Admitted: " << admission_stats.admitted << " (" << admission_stats.backfilled << " backfilled)\n";
+        out << "Swapped out: " << admission_stats.swapped_out << ", swapped back in: " << admission_stats.swapped_in << "\n";
+        if (memory_manager.pagingEnabled()) {
+            out << "Working sets: " << memory_manager.committedFrames() << " / " << total << " frames\n";
+            out << "Page faults: " << memory_manager.totalFaults() << " (" << std::fixed << std::setprecision(1)
+                << memory_manager.recentFaultRate() << " per 100 references recently), evictions: "
+                << memory_manager.totalEvictions() << "\n";
+            out.unsetf(std::ios::floatfield);
+            out << "Suspended by thrash control: " << admission_stats.suspended << "\n";
+        }
+        memory_manager.writeSwapStats(out);
+        if (memory_manager.pagingEnabled()) writeSwapIoStats(out);
+        memory_manager.writeFrameStats(out);
+        memory_manager.writeSharingStats(out);
+    }
+
+    // Caller holds mtx
+    void writeSwapIoStats(std::ostream& out) const {
+        if (!async_swap) {
+            out << "Swap I/O: synchronous (page faults stall their core)\n";
+            return;
+        }
+        size_t writes = memory_manager.queuedSwapWrites();
+        out << "Swap I/O queue: " << swap_reads.size() + writes + swap_prefetches.size() << " (" << swap_reads.size()
+            << " page-ins, " << writes << " write-backs, " << swap_prefetches.size() << " prefetches), peak "
+            << swap_io.peak_depth << ", average " << std::fixed << std::setprecision(1)
+            << (swap_io.depth_samples > 0 ? static_cast<double>(swap_io.depth_total) / swap_io.depth_samples : 0.0)
+            << "\n";
+        out.unsetf(std::ios::floatfield);
+        out << "Page-ins served off-core: " << swap_io.page_ins << ", write-backs rescued by a fault: "
+            << memory_manager.writebackRescues() << "\n";
+        out << "Prefetched pages: " << memory_manager.prefetchedPages() << " (" << memory_manager.prefetchHits()
+            << " used, " << memory_manager.prefetchesUnused() << " evicted unused)\n";
+        out << "Core stall ticks avoided: " << swap_io.stall_ticks_avoided << "\n";
+    }
+
+    // Per-core TLB hit rates and the ticks lost to page walks, printed under vmstat
+    void reportTlb(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        int active = num_cores.load();
+        if (active == 0 || !tlbEnabled(0)) {
+            out << "TLB: not simulated (set tlb-entries)\n";
+            return;
+        }
+        out << "TLB: " << cores[0]->tlb.entries() << " entries, " << cores[0]->tlb.associativity() << "-way, "
+            << (costs.tlb_asid ? "ASID-tagged" : "flushed on switch") << ", miss penalty "
+            << costs.tlb_miss << " ticks\n";
+        long long hits = 0, misses = 0, lost = 0;
+        out << std::fixed << std::setprecision(1);
+        for (int core = 0; core < active; ++core) {
+            std::lock_guard<std::mutex> tlb_lock(cores[core]->tlb_mtx);
+            const Tlb& tlb = cores[core]->tlb;
+            hits += tlb.stats().hits;
+            misses += tlb.stats().misses;
+            lost += cores[core]->stats.tlb_miss_ticks;
+            out << "Core " << core << ": hit rate " << tlb.hitRate() << "% (" << tlb.stats().hits << " hits, "
+                << tlb.stats().misses << " misses), " << tlb.stats().flushes << " flushes, "
+                << tlb.stats().invalidations << " shootdowns, " << cores[core]->stats.tlb_miss_ticks
+                << " ticks lost\n";
+        }
+        out << "Overall TLB hit rate: " << (hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0)
+            << "%, " << lost << " ticks lost to misses\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    // Per-core quantum and its recent changes, printed under vmstat
+    void reportQuantumTuning(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        int active = num_cores.load();
+        if (active == 0 || !cores[0]->tuner.enabled()) {
+            out << "Quantum: fixed at " << quantum_cycles.load() << " cycles\n";
+            return;
+        }
+        out << "Quantum: adaptive (" << cores[0]->tuner.minQuantum() << "-" << cores[0]->tuner.maxQuantum()
+            << " cycles, starting at " << quantum_cycles.load() << ")\n";
+        for (int core = 0; core < active; ++core) {
+            const QuantumController& tuner = cores[core]->tuner;
+            out << "Core " << core << ": quantum " << tuner.quantum()
+                << ", typical burst " << std::fixed << std::setprecision(1) << tuner.burstEstimate()
+                << ", expired " << static_cast<int>(tuner.expireRate() * 100) << "%"
+                << ", switches " << tuner.switches() << "\n";
+            if (!tuner.history().empty()) {
+                out << "  history (tick:quantum):";
+                for (const auto& change : tuner.history()) {
+                    out << " " << change.tick << ":" << change.quantum;
+                }
+                out << "\n";
+            }
+        }
+        out.unsetf(std::ios::floatfield);
+    }
+
+    std::vector<std::shared_ptr<Process>> getProcessQueue() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return process_queue;
+    }
+
+
+    int getQuantumCycles() const {
+        return quantum_cycles.load();
+    }
+
+    int getNumCores() const {
+        return num_cores.load();
+    }
+
+    // O(1) lookup by process name or PID, including finished processes
+    std::shared_ptr<Process> findProcess(const std::string& key) const {
+        std::shared_ptr<Process> process;
+        process_index.find(key, process);
+        return process;
+    }
+
+    // renice <pid> <prio>: a queued process moves to its new place at once, a running one
+    // when it is next queued
+    void renice(const std::string& key, int priority, std::ostream& out) {
+        std::shared_ptr<Process> process = findProcess(key);
+        if (!process) {
+            out << "Process " << key << " not found.\n";
+            return;
+        }
+        if (process->finished.load()) {
+            out << "Process " << process->name << " has finished.\n";
+            return;
+        }
+        int old_priority;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            old_priority = process->priority.exchange(priority);
+            if (process->core_id < static_cast<int>(cores.size())) {
+                cores[process->core_id]->ready_queue->reprioritize(process);
+            }
+        }
+        ready_cv.notify_all();
+        out << "Process " << process->name << ": priority " << old_priority << " -> " << priority << "\n";
+    }
+
+
+    int getActiveTicks() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return quantum_cycle_counter * quantum_cycles; // Example: Total quantum cycles * ticks per quantum
+    }
+    
+    // Builds every process of one tick outside the lock, then appends them in a single critical section
+    void generateBatch(const std::vector<ProcessSpec>& batch, std::vector<std::shared_ptr<Process>>& created) {
+        created.clear();
+        created.reserve(batch.size());
+        std::string start_time = Process::currentTimestamp();
+        int cores = num_cores.load();
+        for (const auto& spec : batch) {
+            int process_id = next_process_id++;
+            if (cluster.running() && placeOnPeer(process_id, spec)) continue;
+            created.push_back(std::make_shared<Process>(process_id, spec.instructions, spec.memory,
+                                                        process_id % cores, start_time));
+            created.back()->program = spec.program;
+            created.back()->priority.store(spec.priority);
+            created.back()->deadline = spec.deadline;
+            process_index.insert(process_id, created.back()->name, created.back());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            process_queue.insert(process_queue.end(), created.begin(), created.end());
+            for (const auto& process : created) {
+                admitRealTime(process);
+                addPending(process);
+            }
+            admitPending();
+        }
+        ready_cv.notify_all();
+    }
+
+    void processGenerator() {
+        std::vector<ProcessSpec> batch;
+        std::vector<std::shared_ptr<Process>> created;
+        while (generator_running.load()) {
+            {
+                std::lock_guard<std::mutex> lock(workload_mtx);
+                workload.generateBatch(batch);
+            }
+            if (!batch.empty()) {
+                generateBatch(batch, created);
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(batch_process_freq.load()));
+        }
+    }
+
+    // Queues a process on its home core; processes homed on a drained core move to a live one.
+    // restored keeps the queueing state read from a checkpoint.
+    void enqueueReady(const std::shared_ptr<Process>& process, bool restored = false) {
+        int core_count = num_cores.load();
+        if (process->core_id >= core_count) {
+            process->core_id = process->id % core_count;
+        }
+        if (restored) {
+            cores[process->core_id]->ready_queue->restore(process);
+        } else {
+            cores[process->core_id]->ready_queue->push(process);
+        }
+    }
+
+    // Every core's ready queue puts real-time processes ahead of the scheduler's own order
+    static ReadyQueueFactory withDeadlines(ReadyQueueFactory fair) {
+        return [fair]() { return std::unique_ptr<ReadyQueue>(new DeadlineReadyQueue(fair())); };
+    }
+
+    // Utilization test for a new process with a deadline. EDF meets every deadline on a core
+    // whose summed density stays at or below 1; the process joins the EDF class on the core
+    // with the most headroom if it still fits under rt_cap there, leaving the rest of the core
+    // to ordinary work, and runs as ordinary work otherwise. Caller holds mtx.
+    void admitRealTime(const std::shared_ptr<Process>& process) {
+        if (process->deadline <= 0) return;
+        int core = leastReservedCore();
+        if (rt_reserved[core] + process->density() > rt_cap) {
+            ++realtime_stats.rejected;
+            return;
+        }
+        process->realtime = true;
+        process->core_id = core;
+        rt_reserved[core] += process->density();
+        ++realtime_stats.admitted;
+    }
+
+    void releaseRealTime(const Process& process) {
+        if (!process.realtime || process.core_id >= static_cast<int>(rt_reserved.size())) return;
+        rt_reserved[process.core_id] = std::max(0.0, rt_reserved[process.core_id] - process.density());
+    }
+
+    int leastReservedCore() const {
+        int best = 0;
+        for (int core = 1; core < num_cores.load(); ++core) {
+            if (rt_reserved[core] < rt_reserved[best]) best = core;
+        }
+        return best;
+    }
+
+    // Recomputes the reservations, moving real-time processes homed on cores that no longer
+    // exist to the least reserved one; a move may overcommit a core. Caller holds mtx.
+    void rebuildReservations() {
+        std::fill(rt_reserved.begin(), rt_reserved.end(), 0.0);
+        std::vector<std::shared_ptr<Process>> homeless;
+        for (const auto& process : process_queue) {
+            if (!process->realtime) continue;
+            if (process->core_id >= num_cores.load()) {
+                homeless.push_back(process);
+            } else {
+                rt_reserved[process->core_id] += process->density();
+            }
+        }
+        for (const auto& process : homeless) {
+            process->core_id = leastReservedCore();
+            rt_reserved[process->core_id] += process->density();
+        }
+    }
+
+    // Puts a process back after a quantum; the queue decides where (e.g. MLFQ demotion)
+    void requeueProcess(const std::shared_ptr<Process>& process, int cycles_used, bool quantum_expired) {
+        int core_count = num_cores.load();
+        if (process->core_id >= core_count) {
+            process->core_id = process->id % core_count;
+        }
+        cores[process->core_id]->ready_queue->requeue(process, cycles_used, quantum_expired);
+    }
+
+    static DispatchCosts readDispatchCosts(const ConfigManager& config) {
+        DispatchCosts read;
+        read.context_switch = std::max(0, config.getContextSwitchTicks());
+        read.migration = std::max(0, config.getMigrationTicks());
+        read.cache_reload = std::max(0, config.getCacheReloadTicks());
+        read.cache_warm = std::max(0, config.getCacheWarmTicks());
+        read.steal = config.stealEnabled();
+        read.steal_min_queue = static_cast<size_t>(std::max(1, config.getStealMinQueue()));
+        read.tlb_entries = std::max(0, config.getTlbEntries());
+        read.tlb_ways = std::max(1, config.getTlbWays());
+        read.tlb_asid = config.tlbAsidTagged();
+        read.tlb_miss = std::max(0, config.getTlbMissTicks());
+        return read;
+    }
+
+    // Moves one process from the longest other queue to an idle core. Queues shorter than
+    // steal_min_queue are left alone, so processes stay on their warm home core unless
+    // their core is genuinely backed up. Caller holds mtx.
+    bool stealWork(int core_id) {
+        if (!costs.steal) return false;
+        int core_count = num_cores.load();
+        int victim = -1;
+        size_t longest = 0;
+        for (int core = 0; core < core_count; ++core) {
+            size_t length = cores[core]->ready_queue->size();
+            if (core != core_id && length >= costs.steal_min_queue && length > longest) {
+                victim = core;
+                longest = length;
+            }
+        }
+        if (victim < 0) return false;
+
+        std::shared_ptr<Process> process = cores[victim]->ready_queue->steal();
+        if (!process) return false;
+        process->core_id = core_id;
+        cores[core_id]->ready_queue->push(process);
+        ++cores[core_id]->stats.steals;
+        return true;
+    }
+
+    // Charges the switch, migration and cache costs of running process on core_id next.
+    // A process is warm on a core it last left fewer than cache_warm busy ticks ago. Caller holds mtx.
+    int dispatchCost(int core_id, const Process& process) {
+        CoreState& core = *cores[core_id];
+        DispatchStats& stats = core.stats;
+        int cost = 0;
+        if (core.last_process_id != process.id) {
+            ++stats.switches;
+            stats.switch_ticks += costs.context_switch;
+            cost += costs.context_switch;
+            if (!costs.tlb_asid) {
+                std::lock_guard<std::mutex> tlb_lock(core.tlb_mtx);
+                core.tlb.flush(); // Untagged entries belong to the old address space
+            }
+        }
+        if (process.last_core >= 0 && process.last_core != core_id) {
+            ++stats.migrations;
+            stats.migration_ticks += costs.migration;
+            cost += costs.migration;
+        }
+        bool warm = process.last_core == core_id && core.active_ticks - process.last_ran_at <= costs.cache_warm;
+        if (warm) {
+            ++stats.warm_dispatches;
+        } else {
+            ++stats.cold_dispatches;
+            stats.reload_ticks += costs.cache_reload;
+            cost += costs.cache_reload;
+        }
+        core.last_process_id = process.id;
+        return cost;
+    }
+
+    static AdmissionPolicy readAdmissionPolicy(const ConfigManager& config) {
+        AdmissionPolicy read;
+        read.max_bypass = std::max(0, config.getAdmissionMaxBypass());
+        read.swap_out = config.swapOutEnabled();
+        read.swap_min_idle = std::max(0, config.getSwapMinIdle());
+        read.page_fault_ticks = std::max(0, config.getPageFaultTicks());
+        read.thrash_fault_rate = config.getThrashFaultRate();
+        read.write_ratio = config.getWriteRatio();
+        read.cow_fault_ticks = std::max(0, config.getCowFaultTicks());
+        read.zswap_load_ticks = std::max(0, config.getZswapLoadTicks());
+        read.swap_prefetch = std::max(0, config.getSwapPrefetch());
+        return read;
+    }
+
+    // Caller holds mtx for all of the admission helpers below
+    void addPending(const std::shared_ptr<Process>& process) {
+        process->pending_frames = memory_manager.demandFrames(*process);
+        if (process->pending_frames > memory_manager.totalFrames()) {
+            // Could never fit; keeping it out of the arrival order stops it blocking everyone else
+            notices().post("Process " + std::to_string(process->id) + " needs more memory than exists; it will not be admitted.");
+            return;
+        }
+        process->pending_seq = ++pending_sequence;
+        process->bypassed = 0;
+        pending_by_size.emplace(std::make_pair(process->pending_frames, process->pending_seq), process);
+        pending_by_age.emplace(process->pending_seq, process);
+    }
+
+    void removePending(const std::shared_ptr<Process>& process) {
+        pending_by_size.erase(std::make_pair(process->pending_frames, process->pending_seq));
+        pending_by_age.erase(process->pending_seq);
+    }
+
+    bool admit(const std::shared_ptr<Process>& process) {
+        if (process->swapped_out) {
+            memory_manager.loadFromBackingStore(process);
+            if (!process->in_memory) return false;
+            process->swapped_out = false;
+            ++admission_stats.swapped_in;
+        } else {
+            if (!memory_manager.allocateMemory(process)) return false;
+            notices().post("Process " + std::to_string(process->id) + " loaded into memory.");
+        }
+        removePending(process);
+        ++admission_stats.admitted;
+        process->runs_since_admit = 0;
+        process->last_active = std::chrono::steady_clock::now();
+        enqueueReady(process);
+        return true;
+    }
+
+    // Admits the oldest pending process whenever it fits. While it does not, smaller processes
+    // backfill the free frames, largest first, until the oldest has been bypassed max_bypass
+    // times; from then on nothing jumps ahead of it and idle residents are swapped out for it.
+    void admitPending() {
+        bool admitted_any = false;
+        while (!pending_by_age.empty()) {
+            std::shared_ptr<Process> oldest = pending_by_age.begin()->second;
+            int free_frames = std::max(0, memory_manager.uncommittedFrames());
+            int oldest_frames = oldest->pending_frames;
+            if (oldest_frames <= free_frames) {
+                if (!admit(oldest)) break;
+                admitted_any = true;
+                continue;
+            }
+
+            std::shared_ptr<Process> backfill;
+            if (oldest->bypassed < admission.max_bypass) {
+                // Largest pending process that still fits in the free frames
+                auto fit = pending_by_size.upper_bound(std::make_pair(free_frames, ~0ULL));
+                if (fit != pending_by_size.begin()) {
+                    backfill = (--fit)->second;
+                }
+            }
+            if (backfill && admit(backfill)) {
+                ++oldest->bypassed;
+                ++admission_stats.backfilled;
+                admitted_any = true;
+                continue;
+            }
+
+            if (!swapOutFor(oldest_frames - free_frames)) break;
+        }
+        if (admitted_any) ready_cv.notify_all();
+    }
+
+    // Swaps out the longest-idle queued residents until frames_short frames are free. Only
+    // processes that have run since they were admitted and have sat idle for swap_min_idle
+    // ticks qualify, so a process cannot be swapped straight back out (no thrashing).
+    // Swaps nothing unless enough frames can be freed, and returns true only once victims that
+    // really left their queues have freed them, so admitPending cannot spin on a failed swap.
+    bool swapOutFor(int frames_short) {
+        if (!admission.swap_out || frames_short <= 0) return false;
+
+        auto now = std::chrono::steady_clock::now();
+        auto min_idle = std::chrono::milliseconds(admission.swap_min_idle * kTickMillis);
+        std::vector<std::shared_ptr<Process>> candidates;
+        for (const auto& process : process_queue) {
+            // A process parked on a page-in is in no ready queue, so swapOut could not take it
+            if (process->in_memory && !process->is_running && !process->swap_blocked &&
+                process->runs_since_admit > 0 && now - process->last_active >= min_idle && !isCurrent(process)) {
+                candidates.push_back(process);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::shared_ptr<Process>& a, const std::shared_ptr<Process>& b) {
+                      return a->last_active < b->last_active;
+                  });
+
+        int freeable = 0;
+        for (const auto& candidate : candidates) {
+            freeable += candidate->committed_frames;
+        }
+        if (freeable < frames_short) return false;
+
+        int freed = 0;
+        for (size_t i = 0; i < candidates.size() && freed < frames_short; ++i) {
+            int frames = candidates[i]->committed_frames;
+            if (!swapOut(candidates[i])) continue;
+            ++admission_stats.swapped_out;
+            freed += frames;
+        }
+        return freed >= frames_short;
+    }
+
+    bool swapOut(const std::shared_ptr<Process>& victim) {
+        if (!cores[victim->core_id]->ready_queue->remove(victim)) return false;
+        memory_manager.addToBackingStore(victim);
+        victim->swapped_out = true;
+        addPending(victim);
+        return true;
+    }
+
+    // Thrash control for demand paging. While the global fault rate is above thrash_fault_rate
+    // and resident working sets add up to more than physical memory, suspends the queued
+    // resident with the worst fault rate until they fit again.
+    void preventThrashing() {
+        if (!memory_manager.pagingEnabled() ||
+            memory_manager.recentFaultRate() <= admission.thrash_fault_rate) {
+            return;
+        }
+        // Only queued residents can be suspended: running and parked ones are in no ready queue
+        std::vector<std::shared_ptr<Process>> candidates;
+        for (const auto& process : process_queue) {
+            if (process->in_memory && !process->is_running && !process->swap_blocked &&
+                process->runs_since_admit > 0 && !isCurrent(process)) {
+                candidates.push_back(process);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::shared_ptr<Process>& a, const std::shared_ptr<Process>& b) {
+                      return a->fault_rate > b->fault_rate;
+                  });
+        for (const auto& candidate : candidates) {
+            if (memory_manager.committedFrames() <= memory_manager.totalFrames()) break;
+            if (swapOut(candidate)) ++admission_stats.suspended;
+        }
+    }
+
+    bool isCurrent(const std::shared_ptr<Process>& process) const {
+        for (const auto& core : cores) {
+            if (core->current == process) return true;
+        }
+        return false;
+    }
+
+    bool tlbEnabled(int core_id) const {
+        std::lock_guard<std::mutex> lock(cores[core_id]->tlb_mtx);
+        return cores[core_id]->tlb.enabled();
+    }
+
+    // What touchPage needs for one quantum: the costs as of dispatch, copied under mtx, and the
+    // stall counters it adds up, folded into the core and swap stats after the quantum
+    struct TouchContext {
+        int tlb_miss = 0;
+        double write_ratio = 0.0;
+        int cow_fault_ticks = 0;
+        int page_fault_ticks = 0;
+        int zswap_load_ticks = 0;
+        long long tlb_miss_ticks = 0;
+        long long stall_ticks_avoided = 0;
+    };
+
+    // Caller holds mtx
+    TouchContext touchContext() const {
+        TouchContext context;
+        context.tlb_miss = costs.tlb_miss;
+        context.write_ratio = admission.write_ratio;
+        context.cow_fault_ticks = admission.cow_fault_ticks;
+        context.page_fault_ticks = admission.page_fault_ticks;
+        context.zswap_load_ticks = admission.zswap_load_ticks;
+        return context;
+    }
+
+    // One memory reference by the process running on core_id; returns the ticks it stalls.
+    // Runs without mtx: the memory manager and the core's TLB lock for themselves, and mtx is
+    // only taken when another core's TLB or the swap stage has to hear about an eviction.
+    int touchPage(int core_id, Process& process, TouchContext& context) {
+        CoreState& core = *cores[core_id];
+        int stall = 0;
+        int page = process.swap_retry_page;
+        if (page >= 0) {
+            process.swap_retry_page = -1;
+        } else {
+            page = process.nextPage(std::max(1, memory_manager.framesFor(process)));
+        }
+        int key = memory_manager.tlbKey(process, page);
+        bool tlb_hit;
+        {
+            std::lock_guard<std::mutex> tlb_lock(core.tlb_mtx);
+            tlb_hit = core.tlb.lookup(process.id, key);
+        }
+        if (!tlb_hit) {
+            stall += context.tlb_miss;
+            context.tlb_miss_ticks += context.tlb_miss;
+        }
+        if (memory_manager.sharingEnabled() && FastRandom::threadLocal().nextDouble() < context.write_ratio &&
+            memory_manager.writePage(process, page)) {
+            stall += context.cow_fault_ticks;
+        }
+        if (memory_manager.pagingEnabled()) {
+            PageEviction evicted;
+            ++process.quantum_steps;
+            bool prefetch_hit = false;
+            PageFault fault = memory_manager.reference(process, page, &evicted, &prefetch_hit);
+            if (prefetch_hit) context.stall_ticks_avoided += context.page_fault_ticks;
+            bool queued_write = fault != PageFault::None && async_swap;
+            if (evicted.process_id >= 0 || queued_write) {
+                std::lock_guard<std::mutex> lock(mtx);
+                shootDown(evicted);
+                if (queued_write) noteSwapDepth(); // The victim's write-back was queued
+            }
+            if (queued_write) swap_cv.notify_one();
+            if (fault == PageFault::Major) {
+                if (async_swap) {
+                    // Park the process until the swap stage has read the page, and let the core run others
+                    process.swap_blocked = true;
+                    process.swap_retry_page = page;
+                    context.stall_ticks_avoided += context.page_fault_ticks;
+                    return -1;
+                }
+                stall += context.page_fault_ticks;
+            } else if (fault == PageFault::Compressed) {
+                stall += context.zswap_load_ticks;
+            }
+        }
+        return stall;
+    }
+
+    // The evicted page's frame now holds something else; drop it from every core's TLB.
+    // Caller holds mtx, so cores is not growing underneath.
+    void shootDown(const PageEviction& evicted) {
+        if (evicted.process_id < 0) return;
+        for (auto& other : cores) {
+            std::lock_guard<std::mutex> tlb_lock(other->tlb_mtx);
+            other->tlb.invalidate(evicted.process_id, evicted.page);
+        }
+    }
+
+    static void writeDispatchCounters(CheckpointWriter& out, const DispatchStats& stats) {
+        const long long counters[] = {stats.switches, stats.switch_ticks, stats.migrations, stats.migration_ticks,
+                                      stats.cold_dispatches, stats.reload_ticks, stats.warm_dispatches, stats.steals,
+                                      stats.tlb_miss_ticks};
+        for (long long counter : counters) out.put<int64_t>(counter);
+    }
+
+    static void readDispatchCounters(CheckpointReader& in, DispatchStats& stats) {
+        long long* counters[] = {&stats.switches, &stats.switch_ticks, &stats.migrations, &stats.migration_ticks,
+                                 &stats.cold_dispatches, &stats.reload_ticks, &stats.warm_dispatches, &stats.steals,
+                                 &stats.tlb_miss_ticks};
+        for (long long* counter : counters) *counter = in.get<int64_t>();
+    }
+
+    static bool restoreFailed(std::ostream& out) {
+        out << "Cannot restore: the checkpoint is damaged or does not match this scheduler.\n";
+        return false;
+    }
+
+    static long long millisSince(std::chrono::steady_clock::time_point started) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    // Caller holds mtx for the swap stage helpers below
+    void noteSwapDepth() {
+        size_t depth = swap_reads.size() + swap_prefetches.size() + memory_manager.queuedSwapWrites();
+        swap_io.peak_depth = std::max(swap_io.peak_depth, depth);
+        swap_io.depth_total += static_cast<long long>(depth);
+        ++swap_io.depth_samples;
+    }
+
+    // Queues reads for the non-resident pages of the region process is currently working in,
+    // up to swap_prefetch of them, so they are in memory by the time it is dispatched
+    void queuePrefetch(const std::shared_ptr<Process>& process) {
+        if (!async_swap || admission.swap_prefetch <= 0 || !process || !process->in_memory ||
+            process->page_frame.empty()) {
+            return;
+        }
+        int pages = static_cast<int>(process->page_frame.size());
+        int region = std::max(1, pages / 4);
+        int queued = 0;
+        for (int i = 0; i < region && queued < admission.swap_prefetch; ++i) {
+            if (swap_prefetches.size() >= kMaxQueuedPrefetches) break;
+            int page = (process->locality_base + i) % pages;
+            if (memory_manager.isResident(*process, page)) continue;
+            bool already = false;
+            for (const auto& request : swap_prefetches) {
+                if (request.first == process && request.second == page) already = true;
+            }
+            if (already) continue;
+            swap_prefetches.push_back(std::make_pair(process, page));
+            ++queued;
+        }
+        if (queued > 0) {
+            noteSwapDepth();
+            swap_cv.notify_one();
+        }
+    }
+
+    // Keeps the lock held except while the simulated device is busy
+    void waitForSwapDevice(std::unique_lock<std::mutex>& lock, int ticks) {
+        if (ticks <= 0) return;
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks * kTickMillis));
+        lock.lock();
+    }
+
+    // The swap I/O stage: one simulated device serving page-ins first, then write-backs, then
+    // prefetches. A backing-store transfer keeps it busy for page_fault_ticks; writes that land
+    // in the compressed pool only cost the compression.
+    void swapIoWorker() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (scheduler_running.load()) {
+            if (!swap_reads.empty()) {
+                // It stays queued while the device is busy, so a checkpoint taken while mtx
+                // is released for the read still finds it
+                std::shared_ptr<Process> process = swap_reads.front();
+                waitForSwapDevice(lock, admission.page_fault_ticks);
+                swap_reads.pop_front();
+                process->swap_blocked = false;
+                ++swap_io.page_ins;
+                requeueProcess(process, 0, false);
+                ready_cv.notify_all();
+            } else if (memory_manager.queuedSwapWrites() > 0) {
+                if (memory_manager.flushSwapWrite()) {
+                    waitForSwapDevice(lock, admission.page_fault_ticks);
+                }
+            } else if (!swap_prefetches.empty()) {
+                std::pair<std::shared_ptr<Process>, int> request = swap_prefetches.front();
+                swap_prefetches.pop_front();
+                const Process& process = *request.first;
+                if (process.finished.load() || !process.in_memory || memory_manager.isResident(process, request.second)) {
+                    continue;
+                }
+                waitForSwapDevice(lock, admission.page_fault_ticks);
+                PageEviction evicted;
+                if (memory_manager.prefetch(*request.first, request.second, &evicted)) {
+                    shootDown(evicted);
+                }
+            } else {
+                swap_cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+        }
+    }
+
+    std::unique_ptr<CoreState> newCoreState() {
+        std::unique_ptr<CoreState> state(new CoreState());
+        state->ready_queue = ready_queue_factory();
+        return state;
+    }
+
+    void addCoreStates(int count) {
+        while (static_cast<int>(cores.size()) < count) {
+            cores.push_back(newCoreState());
+            cores.back()->tuner.configure(quantum_tuning, quantum_cycles.load(), costs.context_switch);
+            cores.back()->tlb.reconfigure(costs.tlb_entries, costs.tlb_ways);
+        }
+        rt_reserved.resize(cores.size(), 0.0);
+        memory_manager.setRegions(count);
+    }
+
+    // Simulated core -> host CPU, walking the allowed CPUs in order so neighbouring cores share a node
+    int hostCpuForCore(int core_id) const {
+        return host_cpus[(pin_cpu_offset + core_id) % host_cpus.size()];
+    }
+
+    void reportCoreMapping(std::ostream& out) const {
+        if (!pin_cores) {
+            out << "CPU affinity: off (core workers float over " << host_cpus.size() << " host CPUs)\n";
+            return;
+        }
+        if (!hostAffinitySupported()) {
+            out << "CPU affinity: pin-cores is not supported on this platform; workers will not be pinned\n";
+            return;
+        }
+        out << "CPU affinity: pinned\n";
+        int core_count = num_cores.load();
+        for (int core = 0; core < core_count; ++core) {
+            int cpu = hostCpuForCore(core);
+            int node = numaNodeOfCpu(cpu);
+            out << "  Core " << core << " -> host CPU " << cpu;
+            if (node >= 0) out << " (NUMA node " << node << ")";
+            out << "\n";
+        }
+    }
+
+    // Runs on the worker thread: pin it, then rebuild its CoreState from that thread
+    void pinCoreWorker(int core_id) {
+        if (!pinCurrentThreadToCpu(hostCpuForCore(core_id))) {
+            return;
+        }
+        std::unique_ptr<CoreState> local = newCoreState();
+        std::lock_guard<std::mutex> lock(mtx);
+        CoreState& old_state = *cores[core_id];
+        std::vector<std::shared_ptr<Process>> queued;
+        old_state.ready_queue->drainTo(queued);
+        for (const auto& process : queued) {
+            local->ready_queue->restore(process); // Same order, levels and aging as before the move
+        }
+        local->current = old_state.current;
+        local->active_ticks = old_state.active_ticks;
+        local->idle_ticks = old_state.idle_ticks;
+        local->tuner = old_state.tuner;
+        local->last_process_id = old_state.last_process_id;
+        local->stats = old_state.stats;
+        local->tlb = old_state.tlb;
+        cores[core_id].swap(local);
+    }
+
+    // Takes the next runnable process for a core. Everything in a ready queue was made
+    // resident by admitPending, so there is nothing to skip here.
+    std::shared_ptr<Process> nextReadyProcess(int core_id) {
+        std::shared_ptr<Process> process = cores[core_id]->ready_queue->pop();
+        if (process) {
+            ++process->runs_since_admit;
+        }
+        return process;
+    }
+
+    // Worker for one simulated core; exits when the scheduler stops or the core is drained
+    void coreWorker(int core_id) {
+        if (pin_cores) {
+            pinCoreWorker(core_id);
+        }
+        MemoryManager::setThreadRegion(core_id); // Frames this core faults in come from its own region
+        // Idle time is counted from the clock in whole ticks, carrying the remainder, so the
+        // extra wakeups a notify_all causes are not counted as ticks
+        bool idle = false;
+        std::chrono::steady_clock::time_point idle_since;
+        while (scheduler_running.load() && core_id < num_cores.load()) {
+            std::shared_ptr<Process> process;
+            ReadyQueue* queue;
+            int quantum;
+            int overhead;
+            TouchContext touch;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                CoreState& core = *cores[core_id];
+                if (idle) {
+                    long long ticks = millisSince(idle_since) / kTickMillis;
+                    core.idle_ticks += ticks;
+                    idle_since += std::chrono::milliseconds(ticks * kTickMillis);
+                }
+                core.ready_queue->advanceClock(core.active_ticks + core.idle_ticks);
+                process = nextReadyProcess(core_id);
+                if (!process && stealWork(core_id)) {
+                    process = nextReadyProcess(core_id);
+                }
+                if (!process) {
+                    if (!idle) {
+                        idle = true;
+                        idle_since = std::chrono::steady_clock::now();
+                    }
+                    admitPending(); // Residents may have idled long enough to swap out
+                    ready_cv.wait_for(lock, std::chrono::milliseconds(kTickMillis));
+                    continue;
+                }
+                idle = false;
+                queuePrefetch(core.ready_queue->peek()); // It runs next on this core
+                // A reloaded or retuned quantum applies from the next dispatch
+                quantum = core.ready_queue->quantumFor(*process, core.tuner.quantum());
+                core.current = process;
+                queue = core.ready_queue.get();
+                overhead = dispatchCost(core_id, *process);
+                touch = touchContext();
+                if (!process->has_run) {
+                    process->has_run = true;
+                    process->first_run_time = std::chrono::steady_clock::now();
+                }
+            }
+
+            // Switch, migration and cache reload time is lost before the first instruction
+            if (overhead > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(overhead * kTickMillis));
+            }
+
+            // Each instruction references one page when the TLB or demand paging is modelled.
+            // A TLB miss stalls it for the page walk and a page fault for the page load.
+            std::function<int()> touch_page;
+            if (memory_manager.pagingEnabled() || memory_manager.sharingEnabled() || tlbEnabled(core_id)) {
+                touch_page = [this, core_id, &process, &touch]() {
+                    return touchPage(core_id, *process, touch);
+                };
+            }
+
+            int cycles_used = process->runQuantum(quantum, [queue, &process]() {
+                return queue->shouldPreempt(*process);
+            }, touch_page);
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                quantum_cycle_counter += quantum;
+                CoreState& core = *cores[core_id];
+                core.current.reset();
+                core.active_ticks += cycles_used;
+                core.stats.tlb_miss_ticks += touch.tlb_miss_ticks;
+                swap_io.stall_ticks_avoided += touch.stall_ticks_avoided;
+                process->last_core = core_id;
+                process->last_ran_at = core.active_ticks;
+                process->last_active = std::chrono::steady_clock::now();
+                core.tuner.record(process->id, cycles_used, cycles_used >= quantum, core.ready_queue->size(),
+                                  core.active_ticks + core.idle_ticks);
+                memory_manager.sampleWorkingSet(*process);
+                if (process->realtime) realtime_stats.ticks += cycles_used;
+                if (process->finished.load()) {
+                    process->finish_time = std::chrono::steady_clock::now();
+                    recordLatency(*process);
+                    releaseRealTime(*process);
+                    memory_manager.releaseMemory(process);
+                    memory_manager.freeSwap(*process);
+                    finished_processes.push_back(process);
+                    process_queue.erase(std::remove(process_queue.begin(), process_queue.end(), process),
+                                        process_queue.end());
+                    admitPending();
+                } else if (process->swap_blocked) {
+                    swap_reads.push_back(process); // The swap stage requeues it once the page is in
+                    noteSwapDepth();
+                    swap_cv.notify_one();
+                } else {
+                    memory_manager.promoteFrames(*process);
+                    requeueProcess(process, cycles_used, cycles_used >= quantum);
+                    preventThrashing();
+                    if (!pending_by_age.empty()) admitPending();
+                }
+            }
+            ready_cv.notify_all();
+        }
+    }
+
+    // Grows or drains the worker pool. Drained cores finish their current quantum and their
+    // queued processes are rehomed onto the remaining cores. Caller holds reconfigure_mtx.
+    void setCoreCount(int new_count) {
+        int old_count = num_cores.load();
+        if (new_count == old_count) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            addCoreStates(new_count);
+            num_cores.store(new_count);
+            if (new_count < old_count) rebuildReservations(); // Before the orphans are rehomed
+            for (int core = new_count; core < old_count; ++core) {
+                std::vector<std::shared_ptr<Process>> orphans;
+                cores[core]->ready_queue->drainTo(orphans);
+                for (const auto& process : orphans) {
+                    enqueueReady(process);
+                }
+            }
+        }
+        ready_cv.notify_all();
+
+        if (!scheduler_running.load()) return;
+
+        if (new_count < old_count) {
+            for (int core = new_count; core < old_count && core < static_cast<int>(core_threads.size()); ++core) {
+                if (core_threads[core].joinable()) core_threads[core].join();
+            }
+            core_threads.resize(new_count);
+        } else {
+            core_threads.resize(new_count);
+            for (int core = old_count; core < new_count; ++core) {
+                core_threads[core] = std::thread(&RoundRobinScheduler::coreWorker, this, core);
+            }
+        }
+    }
+
+    // Applies the current ConfigManager values to the running scheduler. num-cpu, quantum-cycles,
+    // batch-process-freq and the workload settings take effect live; memory sizes need a new initialize.
+    void applyConfig(std::ostream& out) {
+        std::lock_guard<std::mutex> guard(reconfigure_mtx);
+
+        int new_quantum = config.getQuantumCycles();
+        if (new_quantum > 0 && new_quantum != quantum_cycles.load()) {
+            out << "quantum-cycles: " << quantum_cycles.load() << " -> " << new_quantum
+                << " (applies at next dispatch)\n";
+            quantum_cycles.store(new_quantum);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            QuantumTuning new_tuning = config.getQuantumTuning();
+            if (new_tuning.enabled != quantum_tuning.enabled) {
+                out << "adaptive-quantum: " << (new_tuning.enabled ? "on" : "off") << "\n";
+            }
+            quantum_tuning = new_tuning;
+            DispatchCosts new_costs = readDispatchCosts(config);
+            if (new_costs.tlb_entries != costs.tlb_entries || new_costs.tlb_ways != costs.tlb_ways) {
+                out << "TLB: " << costs.tlb_entries << " entries " << costs.tlb_ways << "-way -> "
+                    << new_costs.tlb_entries << " entries " << new_costs.tlb_ways << "-way (contents flushed)\n";
+                for (auto& core : cores) {
+                    std::lock_guard<std::mutex> tlb_lock(core->tlb_mtx);
+                    core->tlb.reconfigure(new_costs.tlb_entries, new_costs.tlb_ways);
+                }
+            }
+            costs = new_costs;
+            admission = readAdmissionPolicy(config);
+            rt_cap = config.getRtUtilizationCap();
+            for (auto& core : cores) {
+                core->tuner.configure(quantum_tuning, quantum_cycles.load(), costs.context_switch);
+            }
+        }
+
+        report_writer.setRotation(config.getReportMaxBytes(), config.getReportKeepFiles());
+
+        int new_freq = config.getBatchProcessFreq();
+        if (new_freq >= 0 && new_freq != batch_process_freq.load()) {
+            out << "batch-process-freq: " << batch_process_freq.load() << " -> " << new_freq << "\n";
+            batch_process_freq.store(new_freq);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(workload_mtx);
+            workload = WorkloadGenerator(config.getWorkloadSettings(), config.getMinInstructions(),
+                                         config.getMaxInstructions(), config.getMinMemPerProc(),
+                                         config.getMaxMemPerProc());
+        }
+
+        int new_cores = config.getNumCPUs();
+        if (new_cores > 0 && new_cores != num_cores.load()) {
+            out << "num-cpu: " << num_cores.load() << " -> " << new_cores << "\n";
+            setCoreCount(new_cores);
+        }
+
+        if (config.getMaxOverallMemory() != memory_manager.getMaxMemory() ||
+            config.getMemPerFrame() != memory_manager.getMemPerFrame()) {
+            out << "Memory settings changed; they apply on the next initialize.\n";
+        }
+    }
+
+    void configWatcher() {
+        while (scheduler_running.load()) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::string error;
+            if (config.reloadIfChanged(error)) {
+                std::ostringstream changes;
+                applyConfig(changes);
+                notices().post("config.txt changed, applying new settings.");
+                std::istringstream lines(changes.str());
+                std::string line;
+                while (std::getline(lines, line)) notices().post(line);
+            } else if (!error.empty()) {
+                notices().post("config.txt changed but was not reloaded: " + error + ".");
+            }
+        }
+    }
+
+    // Copies what viewers need while holding mtx only for the pointer and counter copies;
+    // sorting and string building happen after the lock is released.
+    std::shared_ptr<const SchedulerSnapshot> publishSnapshot() {
+        std::shared_ptr<SchedulerSnapshot> snapshot = std::make_shared<SchedulerSnapshot>();
+        std::vector<Process*> live;
+        std::vector<Process*> running;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            snapshot->sequence = ++snapshot_sequence;
+            snapshot->num_cores = num_cores.load();
+            snapshot->quantum_cycles = quantum_cycles.load();
+            snapshot->process_count = process_queue.size();
+            snapshot->finished_count = finished_processes.size();
+            snapshot->pending_count = pending_by_age.size();
+            snapshot->swap_queue_depth = swap_reads.size() + swap_prefetches.size() + memory_manager.queuedSwapWrites();
+            snapshot->admitted = admission_stats.admitted;
+            snapshot->swapped_out = admission_stats.swapped_out;
+            snapshot->swapped_in = admission_stats.swapped_in;
+            snapshot->suspended = admission_stats.suspended;
+            snapshot->turnaround = turnaround_latency;
+            snapshot->by_priority = priority_latency;
+            snapshot->realtime = realtime_stats;
+            for (int core = 0; core < num_cores.load(); ++core) {
+                snapshot->realtime.reserved += rt_reserved[core];
+            }
+            snapshot->waiting = waiting_latency;
+            snapshot->response = response_latency;
+
+            snapshot->cores.resize(snapshot->num_cores);
+            running.resize(snapshot->num_cores, nullptr);
+            for (int core = 0; core < snapshot->num_cores; ++core) {
+                CoreSnapshot& view = snapshot->cores[core];
+                view.core_id = core;
+                view.ready_length = static_cast<int>(cores[core]->ready_queue->size());
+                view.active_ticks = cores[core]->active_ticks;
+                view.idle_ticks = cores[core]->idle_ticks;
+                const DispatchStats& stats = cores[core]->stats;
+                view.quantum = cores[core]->tuner.quantum();
+                view.switches = stats.switches;
+                view.migrations = stats.migrations;
+                view.steals = stats.steals;
+                view.warm_dispatches = stats.warm_dispatches;
+                view.cold_dispatches = stats.cold_dispatches;
+                view.overhead_ticks = stats.switch_ticks + stats.migration_ticks + stats.reload_ticks;
+                {
+                    std::lock_guard<std::mutex> tlb_lock(cores[core]->tlb_mtx);
+                    view.tlb_hits = cores[core]->tlb.stats().hits;
+                    view.tlb_misses = cores[core]->tlb.stats().misses;
+                }
+                view.tlb_miss_ticks = stats.tlb_miss_ticks;
+                running[core] = cores[core]->current.get();
+                snapshot->ready_count += cores[core]->ready_queue->size();
+            }
+
+            // Raw pointers are safe after unlocking: processes are never freed while the scheduler lives
+            live.reserve(process_queue.size());
+            for (const auto& process : process_queue) {
+                live.push_back(process.get());
+            }
+        }
+        snapshot->taken_at = std::chrono::system_clock::now();
+
+        // Both scan every frame; neither needs mtx, so the cores are not held up by them
+        snapshot->memory = memory_manager.stats();
+        snapshot->max_memory = snapshot->memory.max_memory;
+        snapshot->used_memory = snapshot->memory.used_memory;
+        snapshot->mem_per_frame = snapshot->memory.mem_per_frame;
+        snapshot->huge_ratio = snapshot->memory.huge_ratio;
+        snapshot->memory_map = memory_manager.memoryMap(256);
+
+        for (int core = 0; core < snapshot->num_cores; ++core) {
+            if (running[core]) {
+                snapshot->cores[core].busy = true;
+                snapshot->cores[core].process_id = running[core]->id;
+                snapshot->cores[core].process_name = running[core]->name;
+            }
+        }
+
+        size_t top = std::min(kSnapshotTopProcesses, live.size());
+        std::partial_sort(live.begin(), live.begin() + top, live.end(),
+                          [](const Process* a, const Process* b) { return a->current_step > b->current_step; });
+        snapshot->top_processes.reserve(top);
+        for (size_t i = 0; i < top; ++i) {
+            const Process* process = live[i];
+            ProcessSnapshot view;
+            view.id = process->id;
+            view.name = process->name;
+            view.core_id = process->core_id;
+            view.current_step = process->current_step;
+            view.total_instructions = process->total_instructions;
+            view.memory = process->memory_required;
+            view.priority = process->priority.load();
+            view.running = process->is_running;
+            view.in_memory = process->in_memory;
+            snapshot->top_processes.push_back(view);
+        }
+
+        std::shared_ptr<const SchedulerSnapshot> published = snapshot;
+        std::atomic_store(&latest_snapshot, published);
+        return published;
+    }
+
+    // Lock-free for readers; builds a first snapshot on demand if the publisher has not run yet
+    std::shared_ptr<const SchedulerSnapshot> getSnapshot() {
+        std::shared_ptr<const SchedulerSnapshot> snapshot = std::atomic_load(&latest_snapshot);
+        return snapshot ? snapshot : publishSnapshot();
+    }
+
+    // Memory counters for process-smi and vmstat, all taken at one instant
+    MemorySnapshot memoryStats() const {
+        return memory_manager.stats();
+    }
+
+    // Every live process with its memory and paging figures, for process-smi and the JSON report
+    std::vector<ProcessSnapshot> processSnapshots() const {
+        std::vector<ProcessSnapshot> views;
+        std::lock_guard<std::mutex> lock(mtx);
+        std::unique_lock<std::recursive_mutex> memory_lock = memory_manager.lockState();
+        views.reserve(process_queue.size());
+        for (const auto& process : process_queue) {
+            views.push_back(viewOf(*process));
+        }
+        return views;
+    }
+
+    // One process for process-smi. Cores change its paging counters under mem_mtx and the
+    // rest under mtx, so both are held while it is copied.
+    ProcessSnapshot processSnapshot(const Process& process) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::unique_lock<std::recursive_mutex> memory_lock = memory_manager.lockState();
+        return viewOf(process);
+    }
+
+    // Caller holds mtx and the memory manager's lock
+    ProcessSnapshot viewOf(const Process& process) const {
+        ProcessSnapshot view;
+        view.id = process.id;
+        view.name = process.name;
+        view.core_id = process.core_id;
+        view.current_step = process.current_step;
+        view.total_instructions = process.total_instructions;
+        view.memory = process.memory_required;
+        view.priority = process.priority.load();
+        view.running = process.is_running;
+        view.in_memory = process.in_memory;
+        view.resident_bytes = memory_manager.residentBytes(process);
+        view.working_set = process.working_set;
+        view.page_faults = process.page_faults;
+        view.fault_rate = process.fault_rate;
+        view.finished = process.finished.load();
+        view.deadline = process.deadline;
+        view.realtime = process.realtime;
+        view.program = process.program;
+        view.shared_pages = process.shared_pages;
+        view.shared_mapped = process.shared_mapped;
+        view.cow_faults = process.cow_faults;
+        view.resident_pages = process.resident_pages;
+        view.pages = static_cast<int>(process.page_frame.size());
+        return view;
+    }
+
+    // report-util --json: the same figures as the text report, appended to csopesy-log.json
+    // as one JSON object per line
+    void generateJsonReport(std::ostream& out) {
+        std::shared_ptr<const SchedulerSnapshot> snapshot = publishSnapshot();
+        std::shared_ptr<std::vector<ProcessSnapshot>> processes =
+            std::make_shared<std::vector<ProcessSnapshot>>(processSnapshots()); // Copied here, not on the writer
+        bool queued = report_writer.submit("csopesy-log.json", [snapshot, processes](std::ostream& out) {
+            writeReportJson(*snapshot, *processes, out);
+            return processes->size();
+        });
+        reportQueued(queued, "csopesy-log.json", out);
+    }
+
+    void snapshotPublisher() {
+        while (scheduler_running.load()) {
+            publishSnapshot();
+            std::this_thread::sleep_for(std::chrono::milliseconds(kSnapshotIntervalMs));
+        }
+    }
+
+    void startScheduler() override {
+        std::lock_guard<std::mutex> guard(reconfigure_mtx);
+        if (!scheduler_running.exchange(true)) {
+            int cores = num_cores.load();
+            for (int core = 0; core < cores; ++core) {
+                core_threads.emplace_back(&RoundRobinScheduler::coreWorker, this, core);
+            }
+            snapshot_thread = std::thread(&RoundRobinScheduler::snapshotPublisher, this);
+            if (async_swap) {
+                swap_thread = std::thread(&RoundRobinScheduler::swapIoWorker, this);
+            }
+            if (config.watchEnabled()) {
+                watcher_thread = std::thread(&RoundRobinScheduler::configWatcher, this);
+            }
+            startCluster();
+            if (!config.getMetricsFile().empty()) {
+                metrics_exporter.start(config.getMetricsFile(), config.getMetricsIntervalMs(),
+                                       [this]() { return getSnapshot(); });
+            }
+        }
+        // Core workers keep running after scheduler-stop, so a second start only resumes generation
+        if (!generator_running.exchange(true)) {
+            generator_thread = std::thread(&RoundRobinScheduler::processGenerator, this);
+        }
+    }
+
+    // Cluster mode, started with the scheduler. Nodes that should only run work placed on them
+    // by the coordinator set arrival-rate 0.
+    void startCluster() {
+        std::string socket_path = config.getClusterSocket();
+        if (socket_path.empty()) return;
+        node_name = nodeNameFromPath(socket_path);
+        if (!cluster_node.start(socket_path, this)) {
+            notices().post("Cluster: cannot listen on " + socket_path + "; running standalone.");
+            return;
+        }
+        std::vector<std::string> peers = config.getClusterPeers();
+        if (!peers.empty()) {
+            cluster.start(this, peers, config.getClusterBalanceMs(), config.getClusterImbalance());
+        }
+        std::string notice = "Cluster: node " + node_name + " on " + socket_path;
+        if (!peers.empty()) notice += ", coordinating " + std::to_string(peers.size()) + " peers";
+        notices().post(notice);
+    }
+
+    // Sends a new process to the peer the coordinator picks; false to keep it here
+    bool placeOnPeer(int process_id, const ProcessSpec& spec) {
+        int peer = cluster.choosePlacement(spec.memory);
+        if (peer < 0) return false;
+        MigratedProcess process;
+        process.name = clusterName(node_name, "process" + std::to_string(process_id));
+        process.instructions = spec.instructions;
+        process.memory = spec.memory;
+        process.priority = spec.priority;
+        process.deadline = spec.deadline;
+        return cluster.sendTo(peer, process);
+    }
+
+    NodeStatus clusterStatus() override {
+        NodeStatus status;
+        status.name = node_name;
+        MemorySnapshot memory = memory_manager.stats();
+        status.max_memory = memory.max_memory;
+        status.used_memory = memory.used_memory;
+        std::lock_guard<std::mutex> lock(mtx);
+        status.cores = num_cores.load();
+        for (int core = 0; core < status.cores; ++core) {
+            if (cores[core]->current) ++status.running;
+            status.ready += static_cast<int>(cores[core]->ready_queue->size());
+            status.active_ticks += cores[core]->active_ticks;
+            status.idle_ticks += cores[core]->idle_ticks;
+        }
+        status.pending = static_cast<int>(pending_by_age.size());
+        status.live = static_cast<int>(process_queue.size());
+        status.finished = static_cast<int>(finished_processes.size());
+        status.migrated_in = migrated_in;
+        status.migrated_out = migrated_out;
+        return status;
+    }
+
+    std::vector<NodeProcess> clusterProcesses() override {
+        std::vector<NodeProcess> list;
+        std::lock_guard<std::mutex> lock(mtx);
+        list.reserve(process_queue.size());
+        for (const auto& process : process_queue) {
+            NodeProcess entry;
+            entry.name = process->name;
+            entry.core = process->core_id;
+            entry.current_step = process->current_step;
+            entry.total_instructions = process->total_instructions;
+            entry.state = process->is_running ? "running" : process->in_memory ? "ready" : "waiting";
+            list.push_back(entry);
+        }
+        return list;
+    }
+
+    // A process placed here by the coordinator, new or moved from another node. It queues for
+    // memory like a generated one; false if this node could never hold it.
+    bool adoptProcess(const MigratedProcess& migrated) override {
+        if (migrated.instructions <= 0 || migrated.current_step >= migrated.instructions) return false;
+        int process_id = next_process_id++;
+        auto process = std::make_shared<Process>(process_id, migrated.instructions, migrated.memory,
+                                                 process_id % num_cores.load(), Process::currentTimestamp());
+        process->name = migrated.name;
+        process->current_step = migrated.current_step;
+        process->priority.store(std::max(kMinPriority, std::min(kMaxPriority, migrated.priority)));
+        process->deadline = migrated.deadline;
+        process->arrival_time = std::chrono::steady_clock::now() - std::chrono::milliseconds(migrated.age_ms);
+        if (memory_manager.demandFrames(*process) > memory_manager.totalFrames()) return false;
+        process_index.insert(process_id, process->name, process);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            process_queue.push_back(process);
+            ++migrated_in;
+            admitRealTime(process);
+            addPending(process);
+            admitPending();
+        }
+        ready_cv.notify_all();
+        return true;
+    }
+
+    // Hands queued processes to the coordinator: pending ones first, newest first, since they
+    // hold no memory and the oldest are next in line here; then ready ones, one core at a time.
+    // Real-time processes stay, their utilization is reserved on this node.
+    void releaseQueued(size_t count, std::vector<MigratedProcess>& out) override {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<std::shared_ptr<Process>> leaving;
+        for (auto it = pending_by_age.rbegin(); it != pending_by_age.rend() && leaving.size() < count; ++it) {
+            if (!it->second->realtime && !it->second->swapped_out) leaving.push_back(it->second);
+        }
+        for (const auto& process : leaving) removePending(process);
+        bool took = true;
+        while (took && leaving.size() < count) {
+            took = false;
+            for (int core = 0; core < num_cores.load() && leaving.size() < count; ++core) {
+                std::shared_ptr<Process> process = cores[core]->ready_queue->steal(); // Never real-time
+                if (!process) continue;
+                memory_manager.releaseMemory(process);
+                memory_manager.freeSwap(*process);
+                leaving.push_back(process);
+                took = true;
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& process : leaving) {
+            MigratedProcess migrated;
+            migrated.name = process->name;
+            migrated.instructions = process->total_instructions;
+            migrated.memory = process->memory_required;
+            migrated.current_step = process->current_step;
+            migrated.priority = process->priority.load();
+            migrated.deadline = process->deadline;
+            migrated.age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - process->arrival_time).count();
+            out.push_back(migrated);
+            process_queue.erase(std::remove(process_queue.begin(), process_queue.end(), process), process_queue.end());
+            process_index.erase(process->id, process->name);
+            migrated_processes.push_back(process);
+            ++migrated_out;
+        }
+        if (!leaving.empty()) admitPending(); // Frames given up by ready processes
+    }
+
+    // Cluster sections after the local screen -ls and vmstat; nothing outside cluster mode
+    void writeClusterScreenList(std::ostream& out) {
+        if (cluster.running()) cluster.writeScreenList(out);
+    }
+
+    void writeClusterVmstat(std::ostream& out) {
+        if (cluster.running()) cluster.writeVmstat(out);
+    }
+
+    bool writeClusterStatus(std::ostream& out) {
+        if (!cluster.running()) return false;
+        cluster.writeStatus(out);
+        return true;
+    }
+
+    void stopScheduler() override {
+        generator_running.store(false);
+
+        if (generator_thread.joinable()) {
+            generator_thread.join();
+        }
+    }
+
+    void displayStatus(std::ostream& out) override {
+        std::vector<std::shared_ptr<Process>> process_queue_copy;
+        std::vector<std::shared_ptr<Process>> finished_processes_copy;
+        int cores_used, cores_available;
+        int total_cores = num_cores.load();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            process_queue_copy = process_queue;
+            finished_processes_copy = finished_processes;
+            cores_used = std::min(static_cast<int>(process_queue_copy.size()), total_cores);
+            cores_available = total_cores - cores_used;
+        }
+
+        out << "\nCPU utilization: " << (cores_used * 100 / total_cores) << "%\n";
+        out << "Cores used: " << cores_used << "\n";
+        out << "Cores available: " << cores_available << "\n";
+        out << "-------------------------------------------------------------------------\n";
+        out << "Ready Queue (waiting to run in next cycle):\n";
+        for (const auto& process : process_queue_copy) {
+            if (!process->finished && !process->is_running && process->in_memory) {
+                out << process->getStatus() << "\n";
+            }
+        }
+        out << "-------------------------------------------------------------------------\n";
+        out << "Waiting for Memory (pending admission or swapped out):\n";
+        for (const auto& process : process_queue_copy) {
+            if (!process->finished && !process->in_memory) {
+                out << process->getStatus() << (process->swapped_out ? " [Swapped]" : "") << "\n";
+            }
+        }
+        out << "-------------------------------------------------------------------------\n";
+        out << "Running Processes (currently active in quantum cycle):\n";
+        for (const auto& process : process_queue_copy) {
+            if (process->is_running && !process->finished) {
+                out << process->getStatus() << "\n";
+            }
+        }
+        out << "-------------------------------------------------------------------------\n";
+        out << "Finished Processes:\n";
+        for (const auto& process : finished_processes_copy) {
+            out << process->getStatus() << "\n";
+        }
+    }
+
+    static double ticksBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count() / kTickMillis;
+    }
+
+    // Adds a finished process to the latency histograms; called with mtx held
+    void recordLatency(const Process& process) {
+        double turnaround = ticksBetween(process.arrival_time, process.finish_time);
+        double waiting = std::max(0.0, turnaround - process.total_instructions);
+        long long response = static_cast<long long>(ticksBetween(process.arrival_time, process.first_run_time) + 0.5);
+        turnaround_latency.record(static_cast<long long>(turnaround + 0.5));
+        waiting_latency.record(static_cast<long long>(waiting + 0.5));
+        response_latency.record(response);
+        PriorityLatency& by_priority = priority_latency[process.priority.load()];
+        by_priority.response.record(response);
+        by_priority.turnaround.record(static_cast<long long>(turnaround + 0.5));
+        if (process.realtime) {
+            double lateness = ticksBetween(process.deadlineTime(), process.finish_time);
+            ++realtime_stats.finished;
+            if (lateness > 0.0) ++realtime_stats.missed;
+            realtime_stats.lateness.record(static_cast<long long>(std::max(0.0, lateness) + 0.5));
+        }
+    }
+
+    // checkpoint <file>: the whole scheduler in one sequential pass with mtx and mem_mtx held,
+    // so the snapshot is consistent: cores fault and evict pages under mem_mtx alone, and
+    // holding it keeps the page tables in step with the frame map. Processes in the middle of
+    // a quantum are recorded as of their last completed instruction. The snapshot is built in
+    // memory under the locks; the file is written and synced only after they are released, so
+    // the cores never wait on the disk. TLB contents and quantum tuning history are not saved.
+    bool writeCheckpoint(const std::string& path, std::ostream& report) {
+        auto started = std::chrono::steady_clock::now();
+        CheckpointWriter out(path);
+        if (!out.ok()) {
+            report << "Cannot write checkpoint " << path << ".\n";
+            return false;
+        }
+        size_t process_count;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::unique_lock<std::recursive_mutex> memory_lock = memory_manager.lockState();
+            auto now = std::chrono::steady_clock::now();
+            out.section(kCheckpointScheduler);
+            out.putString(config.getSchedulerType());
+            out.put<int32_t>(next_process_id.load());
+            out.put<int32_t>(quantum_cycle_counter);
+            out.put<uint64_t>(pending_sequence);
+
+            out.section(kCheckpointProcesses);
+            process_count = process_queue.size() + finished_processes.size();
+            out.put<uint64_t>(process_queue.size());
+            out.put<uint64_t>(finished_processes.size());
+            for (const auto& process : process_queue) process->save(out, now);
+            for (const auto& process : finished_processes) process->save(out, now);
+
+            out.section(kCheckpointQueues);
+            out.put<uint64_t>(cores.size());
+            for (const auto& core : cores) {
+                out.put<int64_t>(core->active_ticks);
+                out.put<int64_t>(core->idle_ticks);
+                out.put<int32_t>(core->last_process_id);
+                writeDispatchCounters(out, core->stats);
+                out.put<int32_t>(core->current ? core->current->id : -1);
+                out.put<uint64_t>(core->ready_queue->size());
+                core->ready_queue->forEach([&out](const std::shared_ptr<Process>& process) {
+                    out.put<int32_t>(process->id);
+                });
+            }
+            out.put<uint64_t>(pending_by_age.size());
+            for (const auto& entry : pending_by_age) out.put<int32_t>(entry.second->id);
+            out.put<uint64_t>(swap_reads.size());
+            for (const auto& process : swap_reads) out.put<int32_t>(process->id);
+
+            out.section(kCheckpointStats);
+            const long long admission_counters[] = {admission_stats.admitted, admission_stats.backfilled,
+                                                    admission_stats.swapped_out, admission_stats.swapped_in,
+                                                    admission_stats.suspended};
+            for (long long counter : admission_counters) out.put<int64_t>(counter);
+            out.put<int64_t>(swap_io.page_ins);
+            out.put<int64_t>(swap_io.stall_ticks_avoided);
+            out.put<int64_t>(swap_io.depth_samples);
+            out.put<int64_t>(swap_io.depth_total);
+            out.put<uint64_t>(swap_io.peak_depth);
+            out.put<int64_t>(realtime_stats.admitted);
+            out.put<int64_t>(realtime_stats.rejected);
+            out.put<int64_t>(realtime_stats.ticks);
+
+            out.section(kCheckpointMemory);
+            memory_manager.saveState(out);
+            out.section(kCheckpointEnd);
+        }
+        if (!out.finish()) {
+            report << "Writing checkpoint " << path << " failed.\n";
+            return false;
+        }
+        report << "Checkpoint written to " << path << ": " << process_count << " processes, " << out.bytesWritten()
+               << " bytes in " << millisSince(started) << " ms.\n";
+        return true;
+    }
+
+    // restore <file>: loads a snapshot into this scheduler, which must be freshly built from a
+    // config with the same scheduler and memory settings and not yet started. Processes that
+    // were running, or parked on a page-in, go back to their home core's queue. On failure
+    // the scheduler is left half-loaded and must be discarded.
+    bool restoreCheckpoint(const std::string& path, std::ostream& out) {
+        auto started = std::chrono::steady_clock::now();
+        CheckpointReader in;
+        std::string error;
+        if (!in.open(path, error)) {
+            out << "Cannot restore: " << error << ".\n";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        auto now = std::chrono::steady_clock::now();
+        in.expectSection(kCheckpointScheduler);
+        std::string type = in.getString();
+        if (in.ok() && type != config.getSchedulerType()) {
+            out << "Cannot restore: the checkpoint was taken with scheduler \"" << type
+                << "\" but config.txt selects \"" << config.getSchedulerType() << "\".\n";
+            return false;
+        }
+        next_process_id = in.get<int32_t>();
+        quantum_cycle_counter = in.get<int32_t>();
+        pending_sequence = in.get<uint64_t>();
+
+        in.expectSection(kCheckpointProcesses);
+        uint64_t live = in.get<uint64_t>();
+        uint64_t finished = in.get<uint64_t>();
+        std::unordered_map<int, std::shared_ptr<Process>> by_id;
+        for (uint64_t i = 0; i < live + finished && in.ok(); ++i) {
+            std::shared_ptr<Process> process = Process::load(in, now);
+            if (!process || !by_id.insert(std::make_pair(process->id, process)).second) break;
+            (i < live ? process_queue : finished_processes).push_back(process);
+            process_index.insert(process->id, process->name, process);
+            if (i >= live) recordLatency(*process); // Histograms are rebuilt rather than saved
+        }
+        if (by_id.size() != live + finished) return restoreFailed(out);
+
+        // Every live process goes back exactly once: to a ready queue, or pending admission
+        std::unordered_set<int> placed;
+        auto take = [&by_id, &placed](int id, std::shared_ptr<Process>& out) {
+            auto found = by_id.find(id);
+            if (found == by_id.end() || found->second->finished.load() || !placed.insert(id).second) return false;
+            out = found->second;
+            return true;
+        };
+        std::vector<std::shared_ptr<Process>> runnable, queued_ready;
+        in.expectSection(kCheckpointQueues);
+        uint64_t saved_cores = in.get<uint64_t>();
+        for (uint64_t core = 0; core < saved_cores && in.ok(); ++core) {
+            DispatchStats stats;
+            long long active = in.get<int64_t>();
+            long long idle = in.get<int64_t>();
+            int last_process = in.get<int32_t>();
+            readDispatchCounters(in, stats);
+            if (core < cores.size()) {
+                cores[core]->active_ticks = active;
+                cores[core]->idle_ticks = idle;
+                cores[core]->last_process_id = last_process;
+                cores[core]->stats = stats;
+                cores[core]->ready_queue->advanceClock(active + idle);
+            }
+            int current = in.get<int32_t>();
+            std::shared_ptr<Process> process;
+            if (current >= 0) {
+                if (!take(current, process)) return restoreFailed(out);
+                runnable.push_back(process);
+            }
+            uint64_t queued = in.get<uint64_t>();
+            for (uint64_t i = 0; i < queued; ++i) {
+                if (!take(in.get<int32_t>(), process)) return restoreFailed(out);
+                queued_ready.push_back(process);
+            }
+        }
+        uint64_t pending = in.get<uint64_t>();
+        for (uint64_t i = 0; i < pending; ++i) {
+            std::shared_ptr<Process> process;
+            if (!take(in.get<int32_t>(), process)) return restoreFailed(out);
+            pending_by_size[std::make_pair(process->pending_frames, process->pending_seq)] = process;
+            pending_by_age[process->pending_seq] = process;
+        }
+        uint64_t parked = in.get<uint64_t>();
+        for (uint64_t i = 0; i < parked; ++i) {
+            std::shared_ptr<Process> process;
+            if (!take(in.get<int32_t>(), process)) return restoreFailed(out);
+            process->swap_blocked = false; // Its retry page faults again on the first dispatch
+            runnable.push_back(process);
+        }
+
+        in.expectSection(kCheckpointStats);
+        long long* admission_counters[] = {&admission_stats.admitted, &admission_stats.backfilled,
+                                           &admission_stats.swapped_out, &admission_stats.swapped_in,
+                                           &admission_stats.suspended};
+        for (long long* counter : admission_counters) *counter = in.get<int64_t>();
+        swap_io.page_ins = in.get<int64_t>();
+        swap_io.stall_ticks_avoided = in.get<int64_t>();
+        swap_io.depth_samples = in.get<int64_t>();
+        swap_io.depth_total = in.get<int64_t>();
+        swap_io.peak_depth = static_cast<size_t>(in.get<uint64_t>());
+        realtime_stats.admitted = in.get<int64_t>(); // Finishes and lateness were rebuilt with the histograms
+        realtime_stats.rejected = in.get<int64_t>();
+        realtime_stats.ticks = in.get<int64_t>();
+
+        if (!in.expectSection(kCheckpointMemory)) return restoreFailed(out);
+        if (!memory_manager.loadState(in, by_id, error)) {
+            out << "Cannot restore: " << error << ".\n";
+            return false;
+        }
+        if (!in.expectSection(kCheckpointEnd) || !in.atEnd()) return restoreFailed(out);
+
+        if (placed.size() != process_queue.size()) return restoreFailed(out); // A live process in no queue
+        for (const auto& process : queued_ready) {
+            enqueueReady(process, true);
+        }
+        for (const auto& process : runnable) {
+            enqueueReady(process);
+        }
+        rebuildReservations();
+        out << "Restored " << process_queue.size() << " processes (" << finished_processes.size()
+            << " finished) from " << path << " in " << millisSince(started) << " ms.\n";
+        return true;
+    }
+
+    // A live process's changing fields as of the copy; id, name and start time never change
+    struct StatusRow {
+        const Process* process; // Processes outlive the writer; see the destructor
+        int core_id;
+        int current_step;
+        bool finished;
+    };
+
+    // What report-util needs beyond the snapshot, copied on the command thread so the report
+    // writer never takes mtx or reads a field a core may be changing
+    struct UtilizationRows {
+        std::vector<StatusRow> status;          // Every live process, formatted on the writer
+        std::map<int, size_t> live_by_priority;
+        std::string dispatch_stats, admission_stats;
+    };
+
+    // report-util: the report writer streams it into csopesy-log.txt on its own thread. Only
+    // a few numbers per process are copied under mtx, the counters are rendered by helpers that
+    // take mtx briefly, and every other figure comes from a freshly published snapshot, so
+    // neither the console nor the cores wait on the formatting or the file.
+    void generateUtilizationReport(std::ostream& out) override {
+        std::shared_ptr<const SchedulerSnapshot> snapshot = publishSnapshot();
+        std::shared_ptr<UtilizationRows> rows = std::make_shared<UtilizationRows>();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            rows->status.reserve(process_queue.size());
+            for (const auto& process : process_queue) {
+                StatusRow row = {process.get(), process->core_id, process->current_step.load(),
+                                 process->finished.load()};
+                rows->status.push_back(row);
+                ++rows->live_by_priority[process->priority.load()];
+            }
+        }
+        std::ostringstream dispatch, admission; // Each takes mtx for its own copy
+        writeDispatchStats(dispatch);
+        writeAdmissionStats(admission);
+        rows->dispatch_stats = dispatch.str();
+        rows->admission_stats = admission.str();
+        bool queued = report_writer.submit("csopesy-log.txt", [snapshot, rows](std::ostream& out) {
+            writeUtilizationReport(*snapshot, *rows, out);
+            return rows->status.size();
+        });
+        reportQueued(queued, "csopesy-log.txt", out);
+    }
+
+    static void writeUtilizationReport(const SchedulerSnapshot& snapshot, const UtilizationRows& rows,
+                                       std::ostream& report_file) {
+        int total_cores = std::max(1, snapshot.num_cores);
+        int cores_used = 0;
+        long long active_cpu_ticks = 0, idle_cpu_ticks = 0;
+        for (const auto& core : snapshot.cores) {
+            if (core.busy) ++cores_used;
+            active_cpu_ticks += core.active_ticks;
+            idle_cpu_ticks += core.idle_ticks;
+        }
+        std::time_t taken_at = std::chrono::system_clock::to_time_t(snapshot.taken_at);
+
+        report_file << "=========================================================================\n";
+        report_file << "report-util " << std::put_time(std::localtime(&taken_at), "%m/%d/%Y %I:%M:%S%p") << "\n";
+        report_file << "CPU utilization: " << (cores_used * 100 / total_cores) << "%\n";
+        report_file << "Cores used: " << cores_used << "\n";
+        report_file << "Cores available: " << total_cores - cores_used << "\n";
+        report_file << "-------------------------------------------------------------------------\n";
+        report_file << "Total memory: " << snapshot.max_memory << " KB\n";
+        report_file << "Used memory: " << snapshot.used_memory << " KB\n";
+        report_file << "Free memory: " << snapshot.max_memory - snapshot.used_memory << " KB\n";
+        report_file << "Idle CPU ticks: " << idle_cpu_ticks << "\n";
+        report_file << "Active CPU ticks: " << active_cpu_ticks << "\n";
+        report_file << "-------------------------------------------------------------------------\n";
+        report_file << "Processes in memory:\n";
+        for (const auto& row : rows.status) {
+            row.process->writeStatus(report_file, row.core_id, row.current_step, row.finished);
+            report_file << "\n";
+        }
+        report_file << "-------------------------------------------------------------------------\n";
+        report_file << rows.dispatch_stats;
+        report_file << "-------------------------------------------------------------------------\n";
+        report_file << rows.admission_stats;
+
+        // Turnaround = finish - arrival, response = first dispatch - arrival,
+        // waiting = turnaround - instructions executed; all in ticks
+        const LatencyHistogram* histograms[] = {&snapshot.turnaround, &snapshot.waiting, &snapshot.response};
+        const char* names[] = {"turnaround", "waiting", "response"};
+        if (snapshot.turnaround.count() > 0) {
+            double count = static_cast<double>(snapshot.turnaround.count());
+            report_file << "-------------------------------------------------------------------------\n";
+            report_file << "Finished processes: " << snapshot.finished_count << "\n";
+            report_file << std::fixed << std::setprecision(1);
+            for (int i = 0; i < 3; ++i) {
+                report_file << "Average " << names[i] << ": " << histograms[i]->valueSum() / count << " ticks, p50/p90/p99: "
+                            << histograms[i]->percentile(0.5) << " / " << histograms[i]->percentile(0.9) << " / "
+                            << histograms[i]->percentile(0.99) << " (max " << histograms[i]->maximum() << ")\n";
+            }
+            report_file.unsetf(std::ios::floatfield);
+        }
+        writeRealTimeStats(snapshot, total_cores, report_file);
+        writePriorityStats(snapshot, rows.live_by_priority, report_file);
+    }
+
+    // Deadline misses, lateness and the share of the cores the EDF class used
+    static void writeRealTimeStats(const SchedulerSnapshot& snapshot, int total_cores, std::ostream& out) {
+        const RealTimeStats& realtime = snapshot.realtime;
+        if (realtime.admitted + realtime.rejected == 0) return;
+        long long busy = 0;
+        for (const auto& core : snapshot.cores) busy += core.active_ticks;
+        out << "-------------------------------------------------------------------------\n";
+        out << std::fixed << std::setprecision(1);
+        out << "Real-time (EDF): " << realtime.admitted << " admitted, " << realtime.rejected
+            << " ran best-effort after failing the utilization test, " << realtime.finished << " finished\n";
+        if (realtime.finished > 0) {
+            out << "Deadline misses: " << realtime.missed << " (" << 100.0 * realtime.missed / realtime.finished
+                << "%), lateness p50/p90/p99: " << realtime.lateness.percentile(0.5) << " / "
+                << realtime.lateness.percentile(0.9) << " / " << realtime.lateness.percentile(0.99) << " ticks (max "
+                << realtime.lateness.maximum() << ")\n";
+        }
+        out << "Real-time CPU share: " << (busy > 0 ? 100.0 * realtime.ticks / busy : 0.0) << "% of busy ticks, "
+            << 100.0 * realtime.reserved / total_cores << "% of the cores reserved\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    // Live processes per priority and the latency of the finished ones, so the service
+    // classes can be compared with the batch load
+    static void writePriorityStats(const SchedulerSnapshot& snapshot, const std::map<int, size_t>& waiting,
+                                   std::ostream& out) {
+        std::map<int, PriorityLatency> rows = snapshot.by_priority;
+        for (const auto& entry : waiting) rows[entry.first];
+        if (rows.size() <= 1) return; // Everything at one priority
+        out << "-------------------------------------------------------------------------\n";
+        out << "By priority (live, finished, response avg / p99, turnaround avg / p99 in ticks):\n";
+        out << std::fixed << std::setprecision(1);
+        for (const auto& row : rows) {
+            const PriorityLatency& latency = row.second;
+            double finished = static_cast<double>(latency.response.count());
+            auto found = waiting.find(row.first);
+            out << "Priority " << std::setw(2) << row.first << ": " << (found == waiting.end() ? 0 : found->second)
+                << " live, " << latency.response.count() << " finished";
+            if (finished > 0) {
+                out << ", response " << latency.response.valueSum() / finished << " / "
+                    << latency.response.percentile(0.99) << ", turnaround " << latency.turnaround.valueSum() / finished
+                    << " / " << latency.turnaround.percentile(0.99);
+            }
+            out << "\n";
+        }
+        out.unsetf(std::ios::floatfield);
+    }
+
+    static void reportQueued(bool queued, const std::string& path, std::ostream& out) {
+        if (queued) {
+            out << "Writing the report to " << path << " in the background.\n";
+        } else {
+            out << "Too many reports are queued; try again once one has been saved.\n";
+        }
+    }
+
+};
+
+const int kMlfqMaxLevels = 64; // One bit per level in MLFQReadyQueue's bitmap
+
+// Multi-level feedback queue: one FIFO per level, with a bitmap of non-empty levels so
+// picking the highest non-empty level is a single count-trailing-zeros.
+class MLFQReadyQueue : public ReadyQueue {
+    std::vector<std::deque<std::shared_ptr<Process>>> levels;
+    std::vector<int> quanta;
+    uint64_t non_empty = 0; // Bit i is set while levels[i] has processes
+    size_t count = 0;
+    long long boost_period;
+    long long last_boost = 0;
+    unsigned long long boost_epoch = 0;
+
+    void pushAt(int level, const std::shared_ptr<Process>& process) {
+        levels[level].push_back(process);
+        non_empty |= 1ULL << level;
+        ++count;
+    }
+
+    // Every queued process returns to the top level; processes currently running pick the
+    // boost up through boost_epoch when they are requeued
+    void boost() {
+        ++boost_epoch;
+        for (size_t level = 1; level < levels.size(); ++level) {
+            for (auto& process : levels[level]) {
+                process->queue_level = 0;
+                process->boost_epoch = boost_epoch;
+                levels[0].push_back(process);
+            }
+            levels[level].clear();
+        }
+        non_empty = levels[0].empty() ? 0 : 1;
+    }
+
+public:
+    MLFQReadyQueue(int level_count, const std::vector<int>& level_quanta, int default_quantum, long long boost_period)
+        : levels(std::max(1, std::min(level_count, kMlfqMaxLevels))), boost_period(boost_period) {
+        // Unlisted levels double the previous quantum
+        for (size_t level = 0; level < levels.size(); ++level) {
+            if (level < level_quanta.size() && level_quanta[level] > 0) {
+                quanta.push_back(level_quanta[level]);
+            } else {
+                quanta.push_back(level == 0 ? std::max(1, default_quantum) : quanta.back() * 2);
+            }
+        }
+    }
+
+    void push(const std::shared_ptr<Process>& process) override {
+        if (process->boost_epoch < boost_epoch) {
+            process->queue_level = 0;
+            process->boost_epoch = boost_epoch;
+        }
+        int level = std::min(process->queue_level, static_cast<int>(levels.size()) - 1);
+        process->queue_level = level;
+        pushAt(level, process);
+    }
+
+    // A process from another queue (a checkpoint, or a core that was just pinned) carries
+    // that queue's boost epoch; taking it over keeps the saved level and lets requeue demote
+    // the process again, since a fresh queue starts at epoch 0
+    void restore(const std::shared_ptr<Process>& process) override {
+        boost_epoch = std::max(boost_epoch, process->boost_epoch);
+        push(process);
+    }
+
+    std::shared_ptr<Process> pop() override {
+        if (non_empty == 0) return nullptr;
+        int level = __builtin_ctzll(non_empty);
+        std::shared_ptr<Process> process = levels[level].front();
+        levels[level].pop_front();
+        if (levels[level].empty()) {
+            non_empty &= ~(1ULL << level);
+        }
+        --count;
+        return process;
+    }
+
+    std::shared_ptr<Process> peek() const override {
+        if (non_empty == 0) return nullptr;
+        return levels[__builtin_ctzll(non_empty)].front();
+    }
+
+    size_t size() const override {
+        return count;
+    }
+
+    void drainTo(std::vector<std::shared_ptr<Process>>& out) override {
+        for (auto& level : levels) {
+            out.insert(out.end(), level.begin(), level.end());
+            level.clear();
+        }
+        non_empty = 0;
+        count = 0;
+    }
+
+    void forEach(const std::function<void(const std::shared_ptr<Process>&)>& visit) const override {
+        for (const auto& level : levels) {
+            for (const auto& process : level) visit(process);
+        }
+    }
+
+    bool remove(const std::shared_ptr<Process>& process) override {
+        for (size_t level = 0; level < levels.size(); ++level) {
+            auto& queue = levels[level];
+            auto it = std::find(queue.begin(), queue.end(), process);
+            if (it == queue.end()) continue;
+            queue.erase(it);
+            if (queue.empty()) non_empty &= ~(1ULL << level);
+            --count;
+            return true;
+        }
+        return false;
+    }
+
+    // Using the whole quantum demotes; yielding early keeps the current level
+    void requeue(const std::shared_ptr<Process>& process, int /*cycles_used*/, bool quantum_expired) override {
+        if (quantum_expired && process->boost_epoch == boost_epoch &&
+            process->queue_level < static_cast<int>(levels.size()) - 1) {
+            ++process->queue_level;
+        }
+        push(process);
+    }
+
+    int quantumFor(const Process& process, int /*default_quantum*/) const override {
+        return quanta[std::min(process.queue_level, static_cast<int>(quanta.size()) - 1)];
+    }
+
+    void advanceClock(long long now) override {
+        if (boost_period > 0 && now - last_boost >= boost_period) {
+            last_boost = now;
+            boost();
+        }
+    }
+};
+
+class MLFQScheduler : public RoundRobinScheduler {
+public:
+    explicit MLFQScheduler(ConfigManager& config)
+        : RoundRobinScheduler(config, mlfqFactory(config)) {}
+
+private:
+    static ReadyQueueFactory mlfqFactory(const ConfigManager& config) {
+        int levels = config.getMlfqLevels();
+        std::vector<int> quanta = config.getMlfqQuanta();
+        int quantum = config.getQuantumCycles();
+        long long boost_period = config.getMlfqBoostPeriod();
+        return [levels, quanta, quantum, boost_period]() {
+            return std::unique_ptr<ReadyQueue>(new MLFQReadyQueue(levels, quanta, quantum, boost_period));
+        };
+    }
+};
+
+class FCFSScheduler : public RoundRobinScheduler {
+public:
+    explicit FCFSScheduler(ConfigManager& config)
+        : RoundRobinScheduler(config, []() { return std::unique_ptr<ReadyQueue>(new FcfsReadyQueue()); }) {}
+};
+
+class SRTFScheduler : public RoundRobinScheduler {
+public:
+    explicit SRTFScheduler(ConfigManager& config)
+        : RoundRobinScheduler(config, []() { return std::unique_ptr<ReadyQueue>(new SrtfReadyQueue()); }) {}
+};
+
+class PriorityScheduler : public RoundRobinScheduler {
+public:
+    explicit PriorityScheduler(ConfigManager& config)
+        : RoundRobinScheduler(config, priorityFactory(config)) {}
+
+private:
+    static ReadyQueueFactory priorityFactory(const ConfigManager& config) {
+        long long aging_ticks = config.getPriorityAgingTicks();
+        return [aging_ticks]() { return std::unique_ptr<ReadyQueue>(new PriorityReadyQueue(aging_ticks)); };
     }
+};
+
+// Builds the scheduler named by the scheduler key in config.txt; nullptr if the name is unknown
+Scheduler* createScheduler(ConfigManager& config) {
+    std::string type = config.getSchedulerType();
+    if (type == "rr") return new RoundRobinScheduler(config);
+    if (type == "mlfq") return new MLFQScheduler(config);
+    if (type == "fcfs") return new FCFSScheduler(config);
+    if (type == "srtf") return new SRTFScheduler(config);
+    if (type == "priority") return new PriorityScheduler(config);
+    return nullptr;
 }
 
-void processSMI(const MemoryManager& memory_manager, const std::vector<std::shared_ptr<Process>>& processes) {
-    int total_memory = memory_manager.getMaxMemory();
-    int used_memory = memory_manager.getUsedMemory();
-    int free_memory = memory_manager.getAvailableMemory();
+void processSMI(const MemorySnapshot& memory, const std::vector<ProcessSnapshot>& processes, std::ostream& out) {
+    int total_memory = memory.max_memory;
+    int used_memory = memory.used_memory;
+    int free_memory = total_memory - used_memory;
     int memory_utilization = (used_memory * 100) / total_memory;
 
-    std::cout << "\n| PROCESS-SMI V01.00 Driver Version: 01.00 |\n";
-    std::cout << "---------------------------------------------\n";
-    std::cout << "Total Memory: " << total_memory / 1024 << "kb\n";
-    std::cout << "Used Memory: " << used_memory / 1024 << " kb\n";
-    std::cout << "Free Memory: " << free_memory / 1024 << " kb\n";
-    std::cout << "Memory Utilization: " << memory_utilization << "%\n";
+    out << "\n| PROCESS-SMI V01.00 Driver Version: 01.00 |\n";
+    out << "---------------------------------------------\n";
+    out << "Total Memory: " << total_memory / 1024 << "kb\n";
+    out << "Used Memory: " << used_memory / 1024 << " kb\n";
+    out << "Free Memory: " << free_memory / 1024 << " kb\n";
+    out << "Memory Utilization: " << memory_utilization << "%\n";
 
-    std::cout << "\nRunning processes and memory usage:\n";
+    out << "\nRunning processes and memory usage:\n";
     for (const auto& process : processes) {
-        if (process->in_memory) {
-            int memory_used_by_process = process->allocated_frames.size() * memory_manager.getMemPerFrame();
-            std::cout << "Process " << process->id
-                      << " | Memory: " << memory_used_by_process / 1024 << " kB\n";
+        if (process.in_memory) {
+            out << "Process " << process.id
+                << " | Memory: " << process.resident_bytes / 1024 << " kB";
+            if (memory.paging) {
+                out << " | Working set: " << process.working_set << " pages"
+                    << " | Faults: " << std::fixed << std::setprecision(1) << process.fault_rate << "/100 ins";
+                out.unsetf(std::ios::floatfield);
+            }
+            out << "\n";
+        }
+    }
+    out << "---------------------------------------------\n";
+}
+
+
+void printProcessInfo(const ProcessSnapshot& process, std::ostream& out) {
+    out << "Process: " << process.name << "\n";
+    out << "ID: " << process.id << "\n";
+    out << "Core: " << process.core_id << "\n";
+    out << "Priority: " << process.priority << "\n";
+    if (process.deadline > 0) {
+        out << "Deadline: " << process.deadline << " ticks after arrival ("
+            << (process.realtime ? "EDF" : "best-effort, over the utilization cap") << ")\n";
+    }
+    out << "Current instruction line: " << process.current_step << "\n";
+    out << "Lines of code: " << process.total_instructions << "\n";
+    if (process.shared_pages > 0) {
+        out << "Shared pages: " << process.shared_mapped << " / " << process.shared_pages << " (program "
+            << process.program << ", " << process.cow_faults << " copy-on-write faults)\n";
+    }
+    if (process.pages > 0) {
+        out << "Resident pages: " << process.resident_pages << " / " << process.pages << "\n";
+        out << "Working set: " << process.working_set << " pages\n";
+        out << "Page faults: " << process.page_faults << " (" << std::fixed << std::setprecision(1)
+            << process.fault_rate << " per 100 instructions)\n";
+        out.unsetf(std::ios::floatfield);
+    }
+    if (process.finished) {
+        out << "Finished!\n";
+    }
+}
+
+// process-smi for one process: its figures are copied under the scheduler's locks, since the
+// cores keep changing them (and, with a daemon, client sessions run alongside the cores)
+void printProcessInfo(Scheduler* scheduler, const Process& process, std::ostream& out) {
+    auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+    if (!rrScheduler) {
+        out << "No scheduler initialized.\n";
+        return;
+    }
+    printProcessInfo(rrScheduler->processSnapshot(process), out);
+}
+
+// Attached view of one process, used by screen -r
+void processScreen(Scheduler* scheduler, const std::shared_ptr<Process>& process) {
+    std::cout << "Process " << process->name << ":> ";
+    std::string userCommand;
+    while (std::getline(std::cin, userCommand)) {
+        if (userCommand == "exit") {
+            break;
+        } else if (userCommand == "process-smi") {
+            printProcessInfo(scheduler, *process, std::cout);
+        } else {
+            std::cout << "Invalid command. Type 'process-smi' to view status or 'exit' to go back to the main menu.\n";
         }
+        std::cout << "Process " << process->name << ":> ";
     }
-    std::cout << "---------------------------------------------\n";
 }
 
+// Text form of vmstat --json, read from the same published snapshot
+void vmStat(const SchedulerSnapshot& snapshot, std::ostream& out) {
+    const MemorySnapshot& memory = snapshot.memory;
+    long long idle_ticks = 0, active_ticks = 0;
+    int active_cores = 0;
+    for (const auto& core : snapshot.cores) {
+        idle_ticks += core.idle_ticks;
+        active_ticks += core.active_ticks;
+        if (core.busy) ++active_cores;
+    }
+    int total_memory = memory.max_memory;
+    int used_memory = memory.used_memory;
+    int free_memory = total_memory - used_memory;
+    int external_fragmentation = memory.external_fragmentation;
 
-void vmStat(const MemoryManager& memory_manager, int idle_ticks, int active_ticks, int active_cores, int num_cpu) {
-    int total_memory = memory_manager.getMaxMemory();
-    int used_memory = memory_manager.getUsedMemory();
-    int free_memory = memory_manager.getAvailableMemory();
-    int external_fragmentation = memory_manager.calculateExternalFragmentation();
-
-    std::cout << "VMSTAT: Detailed Memory and CPU Statistics\n";
-    std::cout << "==========================================\n";
-    std::cout << "Total Memory: " << total_memory / 1024 << " MiB\n";
-    std::cout << "Used Memory: " << used_memory / 1024 << " MiB\n";
-    std::cout << "Free Memory: " << free_memory / 1024 << " MiB\n";
-    std::cout << "External Fragmentation: " << external_fragmentation / 1024 << " MiB\n";
-    std::cout << "------------------------------------------\n";
-    std::cout << "Idle CPU Ticks: " << idle_ticks << "\n";
-    std::cout << "Active CPU Ticks: " << active_ticks << "\n";
-    std::cout << "Active Cores: " << active_cores << " / " << num_cpu << "\n";
-    std::cout << "==========================================\n";
+    out << "VMSTAT: Detailed Memory and CPU Statistics\n";
+    out << "==========================================\n";
+    out << "Total Memory: " << total_memory / 1024 << " MiB\n";
+    out << "Used Memory: " << used_memory / 1024 << " MiB\n";
+    out << "Free Memory: " << free_memory / 1024 << " MiB\n";
+    out << "External Fragmentation: " << external_fragmentation / 1024 << " MiB\n";
+    out << "------------------------------------------\n";
+    out << "Idle CPU Ticks: " << idle_ticks << "\n";
+    out << "Active CPU Ticks: " << active_ticks << "\n";
+    out << "Active Cores: " << active_cores << " / " << snapshot.num_cores << "\n";
+    out << "==========================================\n";
 }
 
-int main() {
+// What the command loop works on. The console has one of these; a daemon shares one between
+// every attached client, which take turns through mtx.
+struct Console {
     std::atomic<bool> scheduler_running{false};
     Scheduler* scheduler = nullptr;
-    MemoryManager memory_manager(16384, 4096);  // Default values, updated via config
-    std::vector<std::shared_ptr<Process>> process_queue;
+    ConfigManager config;
+    bool daemon = false;
+    std::mutex mtx;
+};
 
-    while (true) {
-        std::string command;
-        std::cout << "\n\n=========================================================================\nEnter command: ";
-        std::getline(std::cin, command);
+enum class CommandResult { Done, Attach, Exit };
 
-        if (command == "initialize") {
-            int num_cpu, max_mem, mem_per_frame, min_mem_proc, max_mem_proc;
-            std::string scheduler_type;
-            unsigned int quantum_cycles, batch_process_freq, min_ins, max_ins, delays_per_exec;
-            bool use_paging;
+const char* const kCommandBanner = "\n\n=========================================================================\n";
+const char* const kCommandPrompt = "Enter command: ";
+const int kFollowIntervalMs = 250;
 
-            readConfig(num_cpu, scheduler_type, quantum_cycles, batch_process_freq,
-                       min_ins, max_ins, delays_per_exec, max_mem, mem_per_frame, min_mem_proc, max_mem_proc, use_paging);
+// Background notices posted since cursor, printed before the next prompt
+void printNotices(unsigned long long& cursor, std::ostream& out) {
+    std::vector<std::string> lines;
+    size_t missed = notices().readSince(cursor, lines);
+    if (missed > 0) out << "(" << missed << " earlier notices dropped)\n";
+    for (const auto& line : lines) {
+        out << line << "\n";
+    }
+}
 
-            MemoryManager memoryManager(max_mem, mem_per_frame);
+// Runs one main-menu command, writing its output to out. screen -r returns Attach with the
+// process in attached; the caller runs the process screen its own way.
+CommandResult runCommand(Console& console, const std::string& command, std::ostream& out,
+                         std::shared_ptr<Process>& attached) {
+    Scheduler*& scheduler = console.scheduler;
+    std::atomic<bool>& scheduler_running = console.scheduler_running;
+    ConfigManager& config = console.config;
 
-            if (scheduler_type == "rr" && quantum_cycles > 0) {
-                scheduler = new RoundRobinScheduler(quantum_cycles, min_ins, max_ins, batch_process_freq,
-                                                     num_cpu, delays_per_exec, memoryManager);
-                std::cout << "Initialization complete. Scheduler ready.\n";
-            } else {
-                std::cerr << "Error: Invalid scheduler type or parameters.\n";
-                continue;
-            }
-        } else if (command == "scheduler-test") {
-            if (!scheduler) {
-                std::cout << "Please initialize the scheduler first.\n";
-                continue;
-            }
-            if (scheduler_running.load()) {
-                std::cout << "Scheduler is already running.\n";
-                continue;
-            }
-            scheduler_running.store(true);
-            scheduler->startScheduler();
-            std::cout << "Scheduler started.\n";
-        } else if (command == "scheduler-stop") {
-            if (!scheduler_running.load()) {
-                std::cout << "Scheduler is not running.\n";
-                continue;
-            }
+    if (command == "initialize") {
+        std::string error;
+        if (!config.loadConfig("config.txt", error)) {
+            out << "Error: " << error << "\n";
+            return CommandResult::Done;
+        }
+
+        Scheduler* created = nullptr;
+        if (config.getQuantumCycles() > 0 && config.getNumCPUs() > 0 && config.getMemPerFrame() > 0) {
+            created = createScheduler(config);
+        }
+        if (!created) {
+            out << "Error: Invalid scheduler type or parameters.\n";
+            return CommandResult::Done;
+        }
+
+        if (scheduler) {
+            delete scheduler; // Joins the old core workers before replacing them
+            scheduler_running.store(false);
+        }
+        scheduler = created;
+        dynamic_cast<RoundRobinScheduler*>(scheduler)->reportCoreMapping(out);
+        out << "Initialization complete. Scheduler ready (" << config.getSchedulerType() << ").\n";
+    } else if (command == "config reload") {
+        if (!config.isLoaded()) {
+            out << "Please initialize the scheduler first.\n";
+            return CommandResult::Done;
+        }
+        std::string error;
+        if (!config.reload(error)) {
+            out << "Error: " << error << "\n";
+            return CommandResult::Done;
+        }
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (rrScheduler) {
+            rrScheduler->applyConfig(out);
+        }
+        out << "Config reloaded.\n";
+    } else if (command == "scheduler-test") {
+        if (!scheduler) {
+            out << "Please initialize the scheduler first.\n";
+            return CommandResult::Done;
+        }
+        if (scheduler_running.load()) {
+            out << "Scheduler is already running.\n";
+            return CommandResult::Done;
+        }
+        scheduler_running.store(true);
+        scheduler->startScheduler();
+        out << "Scheduler started.\n";
+    } else if (command == "scheduler-stop") {
+        if (!scheduler_running.load()) {
+            out << "Scheduler is not running.\n";
+            return CommandResult::Done;
+        }
+        scheduler->stopScheduler();
+        scheduler_running.store(false);
+        out << "Scheduler stopped.\n";
+    } else if (command == "screen -ls") {
+        if (!scheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        scheduler->displayStatus(out);
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (rrScheduler) rrScheduler->writeClusterScreenList(out);
+    } else if (command == "cluster status") {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler || !rrScheduler->writeClusterStatus(out)) {
+            out << "Cluster mode is off: set cluster-socket and cluster-peers, then run scheduler-test.\n";
+        }
+    } else if (command == "report-util") {
+        if (!scheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        scheduler->generateUtilizationReport(out);
+    } else if (command == "report-util --json") {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        rrScheduler->generateJsonReport(out);
+    } else if (command == "process-smi --json") {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        writeProcessSmiJson(*rrScheduler->publishSnapshot(), rrScheduler->processSnapshots(), out);
+    } else if (command.rfind("process-smi ", 0) == 0 || command.rfind("screen -r ", 0) == 0) {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+
+        bool attach = command.rfind("screen -r ", 0) == 0;
+        std::string key = command.substr(attach ? 10 : 12); // Everything after "screen -r " / "process-smi "
+        auto process = rrScheduler->findProcess(key);
+        if (!process) {
+            out << "Process " << key << " not found.\n";
+        } else if (!attach) {
+            printProcessInfo(rrScheduler->processSnapshot(*process), out);
+        } else if (process->finished.load()) {
+            out << "Process " << process->name << " has finished.\n";
+        } else {
+            attached = process;
+            return CommandResult::Attach;
+        }
+    } else if (command == "process-smi") {
+        if (!scheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (rrScheduler) {
+            processSMI(rrScheduler->memoryStats(), rrScheduler->processSnapshots(), out);
+        } else {
+            out << "Scheduler type does not support process-smi.\n";
+        }
+    } else if (command == "top") {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        if (console.daemon) {
+            out << "top needs a terminal; from an attached client use vmstat --json or screen -ls.\n";
+            return CommandResult::Done;
+        }
+        topDashboard([rrScheduler]() { return rrScheduler->getSnapshot(); }, 10);
+    } else if (command == "vmstat") {
+        if (!scheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (rrScheduler) {
+            vmStat(*rrScheduler->publishSnapshot(), out);
+            rrScheduler->reportQuantumTuning(out);
+            rrScheduler->writeDispatchStats(out);
+            rrScheduler->writeAdmissionStats(out);
+            rrScheduler->reportTlb(out);
+            rrScheduler->writeClusterVmstat(out);
+        } else {
+            out << "Scheduler type does not support vmstat.\n";
+        }
+    } else if (command == "vmstat --json") {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        writeVmstatJson(*rrScheduler->publishSnapshot(), out);
+    } else if (command.rfind("renice ", 0) == 0) {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        std::istringstream args(command.substr(7));
+        std::string key;
+        int priority;
+        if (!(args >> key >> priority) || priority < kMinPriority || priority > kMaxPriority) {
+            out << "Usage: renice <name|pid> <priority " << kMinPriority << "-" << kMaxPriority << ">\n";
+            return CommandResult::Done;
+        }
+        rrScheduler->renice(key, priority, out);
+    } else if (command.rfind("checkpoint ", 0) == 0) {
+        auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
+        if (!rrScheduler) {
+            out << "No scheduler initialized.\n";
+            return CommandResult::Done;
+        }
+        rrScheduler->writeCheckpoint(command.substr(11), out);
+    } else if (command.rfind("restore ", 0) == 0) {
+        if (!config.isLoaded()) {
+            out << "Please initialize the scheduler first.\n";
+            return CommandResult::Done;
+        }
+        // Loads into a fresh scheduler, so a bad file leaves the current one untouched
+        Scheduler* created = createScheduler(config);
+        auto restored = dynamic_cast<RoundRobinScheduler*>(created);
+        if (!restored || !restored->restoreCheckpoint(command.substr(8), out)) {
+            delete created;
+            return CommandResult::Done;
+        }
+        if (scheduler) {
+            scheduler->stopScheduler();
+            delete scheduler;
+        }
+        scheduler = created;
+        scheduler_running.store(false);
+        out << "Run scheduler-test to resume.\n";
+    } else if (command == "exit") {
+        if (scheduler) {
             scheduler->stopScheduler();
+            delete scheduler;
             scheduler_running.store(false);
-            std::cout << "Scheduler stopped.\n";
-        } else if (command == "screen -ls") {
-            if (!scheduler) {
-                std::cout << "No scheduler initialized.\n";
-                continue;
-            }
-            scheduler->displayStatus();
-        } else if (command == "report-util") {
-            if (!scheduler) {
-                std::cout << "No scheduler initialized.\n";
-                continue;
-            }
-            scheduler->generateUtilizationReport();
-        } else if (command == "process-smi") {
-            if (!scheduler) {
-                std::cout << "No scheduler initialized.\n";
-                continue;
-            }
+        }
+        out << "Exiting program.\n";
+        return CommandResult::Exit;
+    } else {
+        out << "Invalid command. Available commands: initialize, config reload, scheduler-test, scheduler-stop, screen -ls, screen -r <name>, report-util [--json], process-smi [name|pid|--json], vmstat [--json], top, renice <pid> <prio>, cluster status, checkpoint <file>, restore <file>, exit\n";
+        if (console.daemon) out << "Attached clients also have: exit (detach this client), shutdown (stop the daemon)\n";
+    }
+    return CommandResult::Done;
+}
 
-            auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
-            if (rrScheduler) {
-                processSMI(memory_manager, rrScheduler->getProcessQueue());
-            } else {
-                std::cout << "Scheduler type does not support process-smi.\n";
-            }
-        } else if (command == "vmstat") {
-            if (!scheduler) {
-                std::cout << "No scheduler initialized.\n";
-                continue;
-            }
+// follow: streams one process's progress to a client until it finishes or the client types
+// a line, which is left in typed (empty if the process finished). Reads only the process's own counters, never the scheduler
+// lock, so any number of followers cost the cores nothing. False once the client has gone.
+bool followProcess(ClientSession& session, const std::shared_ptr<Process>& process, std::string& typed) {
+    typed.clear();
+    int shown = -1;
+    while (true) {
+        int step = process->current_step.load();
+        if (step != shown) {
+            shown = step;
+            std::ostringstream line;
+            line << "Process " << process->name << ": " << step << " / " << process->total_instructions << "\n";
+            if (!session.send(line.str())) return false;
+        }
+        if (process->finished.load()) return session.send("Finished!\n");
+        ClientSession::Input input = session.readLine(typed, kFollowIntervalMs);
+        if (input == ClientSession::Input::Closed) return false;
+        if (input == ClientSession::Input::Line) return true;
+    }
+}
 
-            auto rrScheduler = dynamic_cast<RoundRobinScheduler*>(scheduler);
-            if (rrScheduler) {
-                int active_cores = std::min(static_cast<int>(rrScheduler->getProcessQueue().size()), num_cpu);
-                int idle_ticks = rrScheduler->calculateIdleTicks(num_cpu, active_cores, rrScheduler->getQuantumCycles());
-                int active_ticks = rrScheduler->calculateActiveTicks(active_cores, rrScheduler->getQuantumCycles());
+// One attached client: the console's commands, with the process screen and notices sent over
+// the socket. Commands hold console.mtx while they run; the reply is sent after it is
+// released, so a client that reads slowly never holds up the others.
+void serveClient(Console& console, DaemonServer& server, ClientSession& session) {
+    unsigned long long notice_cursor = notices().latest();
+    std::shared_ptr<Process> attached;
+    std::string command;
+    bool have_command = false; // A line that interrupted a follow, still to be run
+    session.send(kCommandBanner);
+    if (!session.endReply(kCommandPrompt)) return;
 
-                vmStat(memory_manager, idle_ticks, active_ticks, active_cores, num_cpu);
+    while (true) {
+        if (!have_command && session.readLine(command, -1) != ClientSession::Input::Line) return;
+        have_command = false;
+        std::ostringstream out;
+
+        if (attached) {
+            if (command == "exit") {
+                attached.reset();
+            } else if (command == "process-smi") {
+                std::lock_guard<std::mutex> lock(console.mtx); // Another client may be replacing the scheduler
+                printProcessInfo(console.scheduler, *attached, out);
+            } else if (command == "follow") {
+                if (!followProcess(session, attached, command)) return;
+                have_command = !command.empty(); // An empty line just stops following
             } else {
-                std::cout << "Scheduler type does not support vmstat.\n";
+                out << "Invalid command. Type 'process-smi' to view status, 'follow' to watch it run or 'exit' to go "
+                       "back to the main menu.\n";
             }
         } else if (command == "exit") {
-            if (scheduler_running.load()) {
-                scheduler->stopScheduler();
-                delete scheduler;
-                scheduler_running.store(false);
-            }
-            std::cout << "Exiting program.\n";
-            break;
+            session.send("Detached; the daemon keeps running.\n");
+            return;
+        } else if (command == "shutdown") {
+            session.send("Shutting down the daemon.\n");
+            server.stop();
+            return;
+        } else {
+            std::lock_guard<std::mutex> lock(console.mtx);
+            runCommand(console, command, out, attached);
+        }
+        if (have_command) {
+            if (!session.send(out.str())) return;
+            continue;
+        }
+
+        printNotices(notice_cursor, out);
+        if (attached) {
+            if (!session.send(out.str()) || !session.endReply("Process " + attached->name + ":> ")) return;
         } else {
-            std::cout << "Invalid command. Available commands: initialize, scheduler-test, scheduler-stop, screen -ls, report-util, process-smi, vmstat, exit\n";
+            out << kCommandBanner;
+            if (!session.send(out.str()) || !session.endReply(kCommandPrompt)) return;
         }
     }
+}
+
+// The interactive console, as it has always been
+void runConsole() {
+    Console console;
+    unsigned long long notice_cursor = notices().latest();
+    while (true) {
+        printNotices(notice_cursor, std::cout);
+        std::string command;
+        std::cout << kCommandBanner << kCommandPrompt;
+        std::getline(std::cin, command);
+
+        std::shared_ptr<Process> attached;
+        CommandResult result = runCommand(console, command, std::cout, attached);
+        if (result == CommandResult::Exit) break;
+        if (result == CommandResult::Attach) processScreen(console.scheduler, attached);
+    }
+}
 
+// --daemon: detaches, then serves clients until one of them sends shutdown
+int runDaemon(const std::string& socket_path) {
+    DaemonServer server;
+    if (!server.listen(socket_path)) {
+        std::cerr << "Cannot listen on " << socket_path << " (is a daemon already running there?).\n";
+        return 1;
+    }
+    if (!detachFromTerminal("csopesy-daemon.log", "Daemon listening on " + socket_path + ", pid ")) {
+        std::cerr << "Cannot start the daemon in the background.\n";
+        return 1;
+    }
+
+    Console console;
+    console.daemon = true;
+    server.serve([&console, &server](ClientSession& session) { serveClient(console, server, session); });
+    if (console.scheduler) {
+        console.scheduler->stopScheduler();
+        delete console.scheduler;
+    }
+    return 0;
+}
+
+// CSOPESYApp                      the interactive console
+// CSOPESYApp --daemon [socket]    the emulator in the background
+// CSOPESYApp --attach [socket]    a client of a running daemon
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::string socket_path = argc > 2 ? argv[2] : kDefaultDaemonSocket;
+    if (mode == "--daemon") return runDaemon(socket_path);
+    if (mode == "--attach") return runClient(socket_path);
+    if (!mode.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--daemon|--attach [socket]]\n";
+        return 1;
+    }
+    runConsole();
     return 0;
 }
@@ -0,0 +1,373 @@
+#include "metricsExport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+const double kQuantiles[] = {0.5, 0.9, 0.99};
+const char* const kQuantileLabels[] = {"0.5", "0.9", "0.99"};
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// JSON and Prometheus both want plain decimals; NaN and infinities have no JSON spelling
+std::string number(double value) {
+    if (!std::isfinite(value)) return "0";
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", value);
+    return text;
+}
+
+const char* boolean(bool value) {
+    return value ? "true" : "false";
+}
+
+long long epochMillis(const SchedulerSnapshot& snapshot) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(snapshot.taken_at.time_since_epoch()).count();
+}
+
+void writeLatencyJson(const char* name, const LatencyHistogram& histogram, std::ostream& out) {
+    long long count = histogram.count();
+    out << jsonString(name) << ":{\"count\":" << count
+        << ",\"mean\":" << number(count > 0 ? static_cast<double>(histogram.valueSum()) / count : 0.0)
+        << ",\"p50\":" << number(histogram.percentile(0.5))
+        << ",\"p90\":" << number(histogram.percentile(0.9))
+        << ",\"p99\":" << number(histogram.percentile(0.99))
+        << ",\"max\":" << histogram.maximum() << "}";
+}
+
+void writeProcessJson(const ProcessSnapshot& process, std::ostream& out) {
+    out << "{\"id\":" << process.id << ",\"name\":" << jsonString(process.name)
+        << ",\"core\":" << process.core_id << ",\"priority\":" << process.priority
+        << ",\"running\":" << boolean(process.running)
+        << ",\"current_step\":" << process.current_step << ",\"total_instructions\":" << process.total_instructions
+        << ",\"memory_bytes\":" << process.memory << ",\"resident_bytes\":" << process.resident_bytes
+        << ",\"in_memory\":" << boolean(process.in_memory) << ",\"working_set_pages\":" << process.working_set
+        << ",\"page_faults\":" << process.page_faults << ",\"fault_rate\":" << number(process.fault_rate) << "}";
+}
+
+void writeProcessListJson(const std::vector<ProcessSnapshot>& processes, std::ostream& out) {
+    out << "[";
+    for (size_t i = 0; i < processes.size(); ++i) {
+        if (i > 0) out << ",";
+        writeProcessJson(processes[i], out);
+    }
+    out << "]";
+}
+
+void writeMemoryJson(const SchedulerSnapshot& snapshot, std::ostream& out) {
+    const MemorySnapshot& memory = snapshot.memory;
+    out << "\"memory\":{\"total_bytes\":" << snapshot.max_memory << ",\"used_bytes\":" << snapshot.used_memory
+        << ",\"free_bytes\":" << snapshot.max_memory - snapshot.used_memory
+        << ",\"frame_bytes\":" << snapshot.mem_per_frame << ",\"huge_ratio\":" << snapshot.huge_ratio
+        << ",\"total_frames\":" << memory.total_frames << ",\"frames_in_use\":" << memory.frames_in_use
+        << ",\"committed_frames\":" << memory.committed_frames << "}";
+    out << ",\"paging\":{\"enabled\":" << boolean(memory.paging) << ",\"page_faults\":" << memory.page_faults
+        << ",\"evictions\":" << memory.evictions << ",\"recent_fault_rate\":" << number(memory.recent_fault_rate)
+        << ",\"disk_writes\":" << memory.disk_writes << ",\"disk_reads\":" << memory.disk_reads
+        << ",\"prefetched\":" << memory.prefetched << ",\"prefetch_hits\":" << memory.prefetch_hits
+        << ",\"cow_faults\":" << memory.cow_faults << "}";
+    out << ",\"swap_pool\":{\"capacity_bytes\":" << memory.pool_capacity << ",\"used_bytes\":" << memory.pool_used
+        << ",\"pages\":" << memory.pool_pages << ",\"stores\":" << memory.pool_stores
+        << ",\"loads\":" << memory.pool_loads << "}";
+}
+
+// The fields shared by vmstat --json and report-util --json, without the enclosing braces
+void writeSnapshotFields(const SchedulerSnapshot& snapshot, std::ostream& out) {
+    long long active = 0, idle = 0;
+    int busy = 0;
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        active += snapshot.cores[i].active_ticks;
+        idle += snapshot.cores[i].idle_ticks;
+        if (snapshot.cores[i].busy) ++busy;
+    }
+
+    out << "\"sequence\":" << snapshot.sequence << ",\"taken_at_ms\":" << epochMillis(snapshot);
+    out << ",\"cpu\":{\"cores\":" << snapshot.num_cores << ",\"cores_busy\":" << busy
+        << ",\"quantum_cycles\":" << snapshot.quantum_cycles << ",\"active_ticks\":" << active
+        << ",\"idle_ticks\":" << idle << ",\"per_core\":[";
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        const CoreSnapshot& core = snapshot.cores[i];
+        if (i > 0) out << ",";
+        out << "{\"core\":" << core.core_id << ",\"busy\":" << boolean(core.busy)
+            << ",\"process_id\":" << core.process_id << ",\"process\":" << jsonString(core.process_name)
+            << ",\"ready\":" << core.ready_length << ",\"active_ticks\":" << core.active_ticks
+            << ",\"idle_ticks\":" << core.idle_ticks << ",\"quantum\":" << core.quantum
+            << ",\"switches\":" << core.switches << ",\"migrations\":" << core.migrations
+            << ",\"steals\":" << core.steals << ",\"warm_dispatches\":" << core.warm_dispatches
+            << ",\"cold_dispatches\":" << core.cold_dispatches << ",\"overhead_ticks\":" << core.overhead_ticks
+            << ",\"tlb_hits\":" << core.tlb_hits << ",\"tlb_misses\":" << core.tlb_misses
+            << ",\"tlb_miss_ticks\":" << core.tlb_miss_ticks << "}";
+    }
+    out << "]},";
+    writeMemoryJson(snapshot, out);
+    out << ",\"processes\":{\"live\":" << snapshot.process_count << ",\"ready\":" << snapshot.ready_count
+        << ",\"pending\":" << snapshot.pending_count << ",\"finished\":" << snapshot.finished_count << "}";
+    out << ",\"admission\":{\"admitted\":" << snapshot.admitted << ",\"swapped_out\":" << snapshot.swapped_out
+        << ",\"swapped_in\":" << snapshot.swapped_in << ",\"suspended\":" << snapshot.suspended
+        << ",\"swap_queue_depth\":" << snapshot.swap_queue_depth << "}";
+    out << ",\"latency_ticks\":{";
+    writeLatencyJson("turnaround", snapshot.turnaround, out);
+    out << ",";
+    writeLatencyJson("waiting", snapshot.waiting, out);
+    out << ",";
+    writeLatencyJson("response", snapshot.response, out);
+    out << "}";
+    const RealTimeStats& realtime = snapshot.realtime;
+    out << ",\"realtime\":{\"admitted\":" << realtime.admitted << ",\"rejected\":" << realtime.rejected
+        << ",\"finished\":" << realtime.finished << ",\"deadline_misses\":" << realtime.missed
+        << ",\"ticks\":" << realtime.ticks << ",\"reserved\":" << number(realtime.reserved) << ",";
+    writeLatencyJson("lateness_ticks", realtime.lateness, out);
+    out << "}";
+}
+
+// Prometheus helpers: HELP and TYPE once per metric family, then its samples
+void family(std::ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+void sample(std::ostream& out, const char* name, const std::string& labels, const std::string& value) {
+    out << name;
+    if (!labels.empty()) out << "{" << labels << "}";
+    out << " " << value << "\n";
+}
+
+void sample(std::ostream& out, const char* name, const std::string& labels, long long value) {
+    sample(out, name, labels, std::to_string(value));
+}
+
+std::string coreLabel(const CoreSnapshot& core) {
+    return "core=\"" + std::to_string(core.core_id) + "\"";
+}
+
+void writeLatencyPrometheus(const char* kind, const LatencyHistogram& histogram, std::ostream& out) {
+    std::string label = std::string("kind=\"") + kind + "\"";
+    long long cumulative = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::kBuckets; ++bucket) {
+        cumulative += histogram.bucketCount(bucket);
+        long long bound = LatencyHistogram::bucketBound(bucket);
+        std::string le = bound < 0 ? "+Inf" : std::to_string(bound);
+        sample(out, "csopesy_latency_ticks_bucket", label + ",le=\"" + le + "\"", cumulative);
+    }
+    sample(out, "csopesy_latency_ticks_sum", label, histogram.valueSum());
+    sample(out, "csopesy_latency_ticks_count", label, histogram.count());
+}
+}
+
+void writeVmstatJson(const SchedulerSnapshot& snapshot, std::ostream& out) {
+    out << "{";
+    writeSnapshotFields(snapshot, out);
+    out << "}\n";
+}
+
+void writeProcessSmiJson(const SchedulerSnapshot& snapshot, const std::vector<ProcessSnapshot>& processes,
+                         std::ostream& out) {
+    out << "{\"sequence\":" << snapshot.sequence << ",\"taken_at_ms\":" << epochMillis(snapshot) << ",";
+    writeMemoryJson(snapshot, out);
+    out << ",\"processes\":";
+    writeProcessListJson(processes, out);
+    out << "}\n";
+}
+
+void writeReportJson(const SchedulerSnapshot& snapshot, const std::vector<ProcessSnapshot>& processes,
+                     std::ostream& out) {
+    out << "{";
+    writeSnapshotFields(snapshot, out);
+    out << ",\"process_list\":";
+    writeProcessListJson(processes, out);
+    out << "}\n";
+}
+
+void writePrometheus(const SchedulerSnapshot& snapshot, std::ostream& out) {
+    const MemorySnapshot& memory = snapshot.memory;
+
+    family(out, "csopesy_snapshot_sequence", "counter", "Snapshots published since the scheduler started.");
+    sample(out, "csopesy_snapshot_sequence", "", static_cast<long long>(snapshot.sequence));
+    family(out, "csopesy_cores", "gauge", "Emulated CPU cores.");
+    sample(out, "csopesy_cores", "", snapshot.num_cores);
+
+    family(out, "csopesy_core_busy", "gauge", "1 while the core is running a process.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        sample(out, "csopesy_core_busy", coreLabel(snapshot.cores[i]), snapshot.cores[i].busy ? 1 : 0);
+    }
+    family(out, "csopesy_core_ticks_total", "counter", "CPU ticks per core, by state.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        const CoreSnapshot& core = snapshot.cores[i];
+        sample(out, "csopesy_core_ticks_total", coreLabel(core) + ",state=\"active\"", core.active_ticks);
+        sample(out, "csopesy_core_ticks_total", coreLabel(core) + ",state=\"idle\"", core.idle_ticks);
+    }
+    family(out, "csopesy_core_overhead_ticks_total", "counter", "Ticks lost to switches, migrations and cache reloads.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        sample(out, "csopesy_core_overhead_ticks_total", coreLabel(snapshot.cores[i]), snapshot.cores[i].overhead_ticks);
+    }
+    family(out, "csopesy_core_quantum_ticks", "gauge", "Current time quantum per core.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        sample(out, "csopesy_core_quantum_ticks", coreLabel(snapshot.cores[i]), snapshot.cores[i].quantum);
+    }
+    family(out, "csopesy_core_ready_queue_length", "gauge", "Processes waiting in each core's ready queue.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        sample(out, "csopesy_core_ready_queue_length", coreLabel(snapshot.cores[i]), snapshot.cores[i].ready_length);
+    }
+    family(out, "csopesy_core_dispatches_total", "counter", "Dispatches per core, by cache warmth.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        const CoreSnapshot& core = snapshot.cores[i];
+        sample(out, "csopesy_core_dispatches_total", coreLabel(core) + ",cache=\"warm\"", core.warm_dispatches);
+        sample(out, "csopesy_core_dispatches_total", coreLabel(core) + ",cache=\"cold\"", core.cold_dispatches);
+    }
+    family(out, "csopesy_core_events_total", "counter", "Context switches, migrations and work steals per core.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        const CoreSnapshot& core = snapshot.cores[i];
+        sample(out, "csopesy_core_events_total", coreLabel(core) + ",event=\"switch\"", core.switches);
+        sample(out, "csopesy_core_events_total", coreLabel(core) + ",event=\"migration\"", core.migrations);
+        sample(out, "csopesy_core_events_total", coreLabel(core) + ",event=\"steal\"", core.steals);
+    }
+    family(out, "csopesy_core_tlb_lookups_total", "counter", "TLB lookups per core, by result.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        const CoreSnapshot& core = snapshot.cores[i];
+        sample(out, "csopesy_core_tlb_lookups_total", coreLabel(core) + ",result=\"hit\"", core.tlb_hits);
+        sample(out, "csopesy_core_tlb_lookups_total", coreLabel(core) + ",result=\"miss\"", core.tlb_misses);
+    }
+    family(out, "csopesy_core_tlb_miss_ticks_total", "counter", "Ticks spent walking page tables after TLB misses.");
+    for (size_t i = 0; i < snapshot.cores.size(); ++i) {
+        sample(out, "csopesy_core_tlb_miss_ticks_total", coreLabel(snapshot.cores[i]), snapshot.cores[i].tlb_miss_ticks);
+    }
+
+    family(out, "csopesy_processes", "gauge", "Processes by scheduling state.");
+    sample(out, "csopesy_processes", "state=\"live\"", static_cast<long long>(snapshot.process_count));
+    sample(out, "csopesy_processes", "state=\"ready\"", static_cast<long long>(snapshot.ready_count));
+    sample(out, "csopesy_processes", "state=\"pending\"", static_cast<long long>(snapshot.pending_count));
+    sample(out, "csopesy_processes", "state=\"finished\"", static_cast<long long>(snapshot.finished_count));
+
+    family(out, "csopesy_memory_bytes", "gauge", "Emulated physical memory.");
+    sample(out, "csopesy_memory_bytes", "state=\"total\"", snapshot.max_memory);
+    sample(out, "csopesy_memory_bytes", "state=\"used\"", snapshot.used_memory);
+    sample(out, "csopesy_memory_bytes", "state=\"free\"", snapshot.max_memory - snapshot.used_memory);
+    family(out, "csopesy_frames", "gauge", "Page frames by state.");
+    sample(out, "csopesy_frames", "state=\"total\"", memory.total_frames);
+    sample(out, "csopesy_frames", "state=\"in_use\"", memory.frames_in_use);
+    sample(out, "csopesy_frames", "state=\"committed\"", memory.committed_frames);
+    family(out, "csopesy_huge_frame_ratio", "gauge", "Small frames per huge frame.");
+    sample(out, "csopesy_huge_frame_ratio", "", snapshot.huge_ratio);
+
+    family(out, "csopesy_page_faults_total", "counter", "Page faults since start.");
+    sample(out, "csopesy_page_faults_total", "", memory.page_faults);
+    family(out, "csopesy_page_evictions_total", "counter", "Pages evicted from memory.");
+    sample(out, "csopesy_page_evictions_total", "", memory.evictions);
+    family(out, "csopesy_page_fault_rate", "gauge", "Recent page faults per 100 references.");
+    sample(out, "csopesy_page_fault_rate", "", number(memory.recent_fault_rate));
+    family(out, "csopesy_cow_faults_total", "counter", "Copy-on-write faults on shared program pages.");
+    sample(out, "csopesy_cow_faults_total", "", memory.cow_faults);
+    family(out, "csopesy_backing_store_pages_total", "counter", "Pages moved to and from the backing store.");
+    sample(out, "csopesy_backing_store_pages_total", "op=\"write\"", memory.disk_writes);
+    sample(out, "csopesy_backing_store_pages_total", "op=\"read\"", memory.disk_reads);
+    family(out, "csopesy_prefetched_pages_total", "counter", "Pages read ahead of a fault.");
+    sample(out, "csopesy_prefetched_pages_total", "", memory.prefetched);
+    family(out, "csopesy_prefetch_hits_total", "counter", "Prefetched pages that were later referenced.");
+    sample(out, "csopesy_prefetch_hits_total", "", memory.prefetch_hits);
+
+    family(out, "csopesy_swap_pool_bytes", "gauge", "Compressed swap pool size.");
+    sample(out, "csopesy_swap_pool_bytes", "state=\"capacity\"", memory.pool_capacity);
+    sample(out, "csopesy_swap_pool_bytes", "state=\"used\"", memory.pool_used);
+    family(out, "csopesy_swap_pool_pages", "gauge", "Pages held compressed in the swap pool.");
+    sample(out, "csopesy_swap_pool_pages", "", memory.pool_pages);
+    family(out, "csopesy_swap_pool_ops_total", "counter", "Compressed swap pool stores and loads.");
+    sample(out, "csopesy_swap_pool_ops_total", "op=\"store\"", memory.pool_stores);
+    sample(out, "csopesy_swap_pool_ops_total", "op=\"load\"", memory.pool_loads);
+    family(out, "csopesy_swap_queue_depth", "gauge", "Requests waiting for the swap device.");
+    sample(out, "csopesy_swap_queue_depth", "", static_cast<long long>(snapshot.swap_queue_depth));
+
+    family(out, "csopesy_admissions_total", "counter", "Processes admitted into memory.");
+    sample(out, "csopesy_admissions_total", "", snapshot.admitted);
+    family(out, "csopesy_process_swaps_total", "counter", "Whole-process swaps, by direction.");
+    sample(out, "csopesy_process_swaps_total", "direction=\"out\"", snapshot.swapped_out);
+    sample(out, "csopesy_process_swaps_total", "direction=\"in\"", snapshot.swapped_in);
+    family(out, "csopesy_thrash_suspensions_total", "counter", "Processes suspended to stop thrashing.");
+    sample(out, "csopesy_thrash_suspensions_total", "", snapshot.suspended);
+
+    family(out, "csopesy_latency_ticks", "histogram", "Turnaround, waiting and response time of finished processes.");
+    writeLatencyPrometheus("turnaround", snapshot.turnaround, out);
+    writeLatencyPrometheus("waiting", snapshot.waiting, out);
+    writeLatencyPrometheus("response", snapshot.response, out);
+    family(out, "csopesy_latency_quantile_ticks", "gauge", "Latency percentiles estimated from the histogram.");
+    const char* kinds[] = {"turnaround", "waiting", "response"};
+    const LatencyHistogram* histograms[] = {&snapshot.turnaround, &snapshot.waiting, &snapshot.response};
+    for (int kind = 0; kind < 3; ++kind) {
+        for (int q = 0; q < 3; ++q) {
+            sample(out, "csopesy_latency_quantile_ticks",
+                   std::string("kind=\"") + kinds[kind] + "\",quantile=\"" + kQuantileLabels[q] + "\"",
+                   number(histograms[kind]->percentile(kQuantiles[q])));
+        }
+    }
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::start(const std::string& file, int interval, SnapshotSource snapshots) {
+    stop();
+    path = file;
+    interval_ms = std::max(100, interval);
+    source = snapshots;
+    active = true;
+    worker = std::thread(&MetricsExporter::loop, this);
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mtx);
+        active = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+bool MetricsExporter::exportOnce() {
+    if (!source || path.empty()) return false;
+    std::shared_ptr<const SchedulerSnapshot> snapshot = source();
+    if (!snapshot) return false;
+
+    // Render first so the file is open only for one write
+    std::ostringstream text;
+    writePrometheus(*snapshot, text);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp.c_str(), std::ios::trunc);
+        if (!out) return false;
+        out << text.str();
+        if (!out.flush()) return false;
+    }
+    // rename() replaces the old file in one step on POSIX
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::loop() {
+    std::unique_lock<std::mutex> lock(wake_mtx);
+    while (active) {
+        lock.unlock();
+        exportOnce();
+        lock.lock();
+        wake.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return !active.load(); });
+    }
+}
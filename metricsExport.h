@@ -0,0 +1,63 @@
+#ifndef METRICS_EXPORT_H
+#define METRICS_EXPORT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "schedulerSnapshot.h"
+
+// Machine-readable renderings of a published SchedulerSnapshot. Nothing here touches
+// scheduler state, so dashboards can poll as often as they like without taking its lock.
+
+// vmstat --json: CPU, memory, paging, admission and latency figures as one JSON object
+void writeVmstatJson(const SchedulerSnapshot& snapshot, std::ostream& out);
+
+// process-smi --json: memory summary plus one entry per process
+void writeProcessSmiJson(const SchedulerSnapshot& snapshot, const std::vector<ProcessSnapshot>& processes,
+                         std::ostream& out);
+
+// report-util --json: everything vmstat --json has, plus the process list
+void writeReportJson(const SchedulerSnapshot& snapshot, const std::vector<ProcessSnapshot>& processes,
+                     std::ostream& out);
+
+// Prometheus text exposition format (version 0.0.4), every counter and gauge in the snapshot
+void writePrometheus(const SchedulerSnapshot& snapshot, std::ostream& out);
+
+// Rewrites a metrics file in Prometheus format every interval. Each write goes to a temporary
+// file that is renamed over the old one, so scrapers never see a half-written file.
+class MetricsExporter {
+public:
+    typedef std::function<std::shared_ptr<const SchedulerSnapshot>()> SnapshotSource;
+
+    MetricsExporter() {}
+    ~MetricsExporter();
+
+    void start(const std::string& path, int interval_ms, SnapshotSource source);
+    void stop();
+    bool running() const { return active.load(); }
+
+    // One write, outside the schedule; false if the file could not be replaced
+    bool exportOnce();
+
+private:
+    MetricsExporter(const MetricsExporter&);
+    MetricsExporter& operator=(const MetricsExporter&);
+
+    void loop();
+
+    std::string path;
+    int interval_ms = 1000;
+    SnapshotSource source;
+    std::atomic<bool> active{false};
+    std::mutex wake_mtx;
+    std::condition_variable wake;
+    std::thread worker;
+};
+
+#endif // METRICS_EXPORT_H
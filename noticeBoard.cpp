@@ -0,0 +1,35 @@
+#include "noticeBoard.h"
+
+const size_t NoticeBoard::kCapacity;
+
+void NoticeBoard::post(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.push_back(text);
+    if (entries.size() > kCapacity) entries.pop_front();
+    ++next_sequence;
+}
+
+unsigned long long NoticeBoard::latest() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return next_sequence;
+}
+
+size_t NoticeBoard::readSince(unsigned long long& cursor, std::vector<std::string>& out) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    unsigned long long first = next_sequence - entries.size();
+    size_t missed = 0;
+    if (cursor < first) {
+        missed = static_cast<size_t>(first - cursor);
+        cursor = first;
+    }
+    for (unsigned long long sequence = cursor; sequence < next_sequence; ++sequence) {
+        out.push_back(entries[static_cast<size_t>(sequence - first)]);
+    }
+    cursor = next_sequence;
+    return missed;
+}
+
+NoticeBoard& notices() {
+    static NoticeBoard board;
+    return board;
+}
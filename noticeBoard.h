@@ -0,0 +1,36 @@
+#ifndef NOTICE_BOARD_H
+#define NOTICE_BOARD_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Messages from background threads: admissions, saved reports, config reloads. They are kept
+// here instead of being printed where they happen, so they never land in the middle of a
+// prompt or of another command's output. Every reader (the console, each attached client)
+// keeps its own cursor and shows what is new before its next prompt; posting is one short
+// lock, however many readers there are or however slow they are.
+class NoticeBoard {
+public:
+    static const size_t kCapacity = 256; // Older notices are dropped once this many are kept
+
+    void post(const std::string& text);
+
+    // Sequence number of the next notice; a new reader starts here to see only what follows
+    unsigned long long latest() const;
+
+    // Appends the notices after cursor, oldest first, and moves cursor past them. Returns how
+    // many the reader missed because they were dropped first.
+    size_t readSince(unsigned long long& cursor, std::vector<std::string>& out) const;
+
+private:
+    mutable std::mutex mtx;
+    std::deque<std::string> entries;
+    unsigned long long next_sequence = 0; // entries.front() is next_sequence - entries.size()
+};
+
+// The board shared by the whole program
+NoticeBoard& notices();
+
+#endif // NOTICE_BOARD_H
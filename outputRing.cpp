@@ -0,0 +1,69 @@
+#include "outputRing.h"
+#include <algorithm>
+
+const size_t OutputRing::kDefaultCapacity;
+
+void parseOutputFlush(const std::string& name, OutputFlush& flush) {
+    if (name == "off") flush = OutputFlush::Off;
+    else if (name == "batch") flush = OutputFlush::Batch;
+    else if (name == "exit") flush = OutputFlush::Exit;
+}
+
+OutputRing::OutputRing(size_t capacity) : slots(std::max<size_t>(1, capacity)) {}
+
+void OutputRing::configure(size_t capacity, OutputFlush new_flush, size_t new_batch) {
+    std::lock_guard<std::mutex> lock(mtx);
+    slots.assign(std::max<size_t>(1, capacity), std::string());
+    next = 0;
+    count = 0;
+    unwritten = 0;
+    flush = new_flush;
+    // Under exit the only early batch is a full ring
+    batch = flush == OutputFlush::Exit ? slots.size() : std::min(std::max<size_t>(1, new_batch), slots.size());
+}
+
+bool OutputRing::append(const std::string& line) {
+    std::lock_guard<std::mutex> lock(mtx);
+    slots[next] = line;
+    next = (next + 1) % slots.size();
+    ++count;
+    if (flush == OutputFlush::Off) return false;
+    if (unwritten < slots.size()) ++unwritten; // Otherwise the oldest unwritten line was just overwritten
+    return unwritten >= batch;
+}
+
+std::vector<std::string> OutputRing::recent(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t kept = std::min(std::min(count, slots.size()), limit);
+    std::vector<std::string> lines;
+    lines.reserve(kept);
+    size_t first = (next + slots.size() - kept) % slots.size();
+    for (size_t i = 0; i < kept; ++i) {
+        lines.push_back(slots[(first + i) % slots.size()]);
+    }
+    return lines;
+}
+
+size_t OutputRing::total() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
+
+bool OutputRing::takeBatch(std::vector<std::string>& out, bool all) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (unwritten == 0 || (!all && unwritten < batch)) return false;
+    size_t taking = all ? unwritten : batch;
+    size_t first = (next + slots.size() - unwritten) % slots.size();
+    out.clear();
+    out.reserve(taking);
+    for (size_t i = 0; i < taking; ++i) {
+        out.push_back(slots[(first + i) % slots.size()]);
+    }
+    unwritten -= taking;
+    return true;
+}
+
+void OutputRing::returnBatch(size_t lines) {
+    std::lock_guard<std::mutex> lock(mtx);
+    unwritten = std::min(unwritten + lines, slots.size());
+}
@@ -0,0 +1,69 @@
+#ifndef OUTPUT_RING_H
+#define OUTPUT_RING_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// When a process's output reaches its <name>.txt file
+enum class OutputFlush {
+    Off,    // Never: the output lives only in memory
+    Batch,  // Every batch lines, and whatever is left when the process exits
+    Exit    // When the process exits, or earlier whenever the ring fills with unwritten lines
+};
+
+// "off", "batch" or "exit"; anything else leaves flush unchanged
+void parseOutputFlush(const std::string& name, OutputFlush& flush);
+
+// The recent output of one process, kept in memory so screen -r and process-smi show it at
+// once. The newest capacity lines live in a fixed ring: appending copies into the next slot
+// under a short lock and never touches a file. With flushing on, batches are copied out of
+// the ring slots themselves, so memory stays at capacity lines whatever the mode; a batch is
+// ready at the latest when every slot holds an unwritten line. Appends, takeBatch and
+// returnBatch come from one thread (the process's own); recent and total from any.
+//
+// Only the consoleManager and ScreenProcess front ends have screen processes that print.
+// The scheduler's processes in main.cpp run instructions that produce no output, so their
+// screen -r and process-smi show progress and memory, not a ring.
+class OutputRing {
+public:
+    static const size_t kDefaultCapacity = 100;
+
+    explicit OutputRing(size_t capacity = kDefaultCapacity);
+
+    // Empties the ring and sets how lines are kept and flushed; call before the first append.
+    // batch is capped at capacity.
+    void configure(size_t capacity, OutputFlush flush, size_t batch);
+
+    // Returns true when a batch is ready for takeBatch. If the batch was not taken by the time
+    // the ring comes round again, the oldest unwritten line is overwritten and lost.
+    bool append(const std::string& line);
+
+    // Up to limit of the newest lines, oldest first
+    std::vector<std::string> recent(size_t limit) const;
+
+    size_t total() const;      // Lines appended since configure, including overwritten ones
+
+    // Copies the oldest unwritten lines into out and marks them written: a full batch, or with
+    // all every unwritten line. False if there was nothing to take.
+    bool takeBatch(std::vector<std::string>& out, bool all);
+
+    // Marks the last lines taken unwritten again, after a writer refused them; they are still
+    // in their slots as long as nothing was appended since takeBatch
+    void returnBatch(size_t lines);
+
+private:
+    OutputRing(const OutputRing&);
+    OutputRing& operator=(const OutputRing&);
+
+    mutable std::mutex mtx;
+    std::vector<std::string> slots;
+    size_t next = 0;           // Slot the next line goes into
+    size_t count = 0;          // Lines appended
+    size_t unwritten = 0;      // Newest lines not yet handed to a writer; at most slots.size()
+    OutputFlush flush = OutputFlush::Off;
+    size_t batch = 0;
+};
+
+#endif // OUTPUT_RING_H
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <chrono>
+#include "outputRing.h"
 
 class Process {
 public:
@@ -23,6 +24,7 @@ public:
     std::chrono::system_clock::time_point getEndTime() const;
 
     std::string processName;                 // Public for easy access in this example
+    OutputRing output;                       // Recent PRINT lines, shown by screen -r and process-smi
 
 private:
     int id;                                  // Unique ID for each process
@@ -0,0 +1,116 @@
+#ifndef PROCESS_INDEX_H
+#define PROCESS_INDEX_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+// Concurrent lookup table from process ID and process name to a handle (pointer or shared_ptr).
+// Entries stay after a process finishes so finished processes can still be found.
+// Both keys are split over independently locked shards, so lookups from the console
+// rarely contend with the scheduler registering new processes.
+template <typename Handle>
+class ProcessIndex {
+public:
+    explicit ProcessIndex(size_t shard_count = 64) {
+        for (size_t i = 0; i < shard_count; ++i) {
+            id_shards.emplace_back(new Shard<int>());
+            name_shards.emplace_back(new Shard<std::string>());
+        }
+    }
+
+    // Registers (or replaces) both keys for a process
+    void insert(int id, const std::string& name, const Handle& handle) {
+        {
+            Shard<int>& shard = idShard(id);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            shard.entries[id] = handle;
+        }
+        if (!name.empty()) {
+            Shard<std::string>& shard = nameShard(name);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            shard.entries[name] = handle;
+        }
+    }
+
+    bool findById(int id, Handle& out) const {
+        const Shard<int>& shard = idShard(id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.entries.find(id);
+        if (it == shard.entries.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    bool findByName(const std::string& name, Handle& out) const {
+        const Shard<std::string>& shard = nameShard(name);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.entries.find(name);
+        if (it == shard.entries.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    // Accepts either a process name or a numeric PID; names win when both match
+    bool find(const std::string& key, Handle& out) const {
+        if (findByName(key, out)) return true;
+        if (key.empty() || key.find_first_not_of("0123456789") != std::string::npos || key.size() > 9) return false;
+        return findById(std::stoi(key), out);
+    }
+
+    void erase(int id, const std::string& name) {
+        {
+            Shard<int>& shard = idShard(id);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            shard.entries.erase(id);
+        }
+        if (!name.empty()) {
+            Shard<std::string>& shard = nameShard(name);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            shard.entries.erase(name);
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : id_shards) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            total += shard->entries.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (auto& shard : id_shards) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            shard->entries.clear();
+        }
+        for (auto& shard : name_shards) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            shard->entries.clear();
+        }
+    }
+
+private:
+    template <typename Key>
+    struct Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<Key, Handle> entries;
+    };
+
+    std::vector<std::unique_ptr<Shard<int>>> id_shards;
+    std::vector<std::unique_ptr<Shard<std::string>>> name_shards;
+
+    Shard<int>& idShard(int id) const {
+        return *id_shards[static_cast<size_t>(id) % id_shards.size()];
+    }
+
+    Shard<std::string>& nameShard(const std::string& name) const {
+        return *name_shards[std::hash<std::string>()(name) % name_shards.size()];
+    }
+};
+
+#endif // PROCESS_INDEX_H
@@ -0,0 +1,113 @@
+#include "quantumController.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t kHistoryLength = 16;
+const double kBurstSmoothing = 0.25;   // Weight of the newest burst in the EWMA
+const double kBurstHeadroom = 1.25;    // Quantum covers the typical burst plus a margin
+const double kExpireThreshold = 0.5;   // Above this share of expirations the quantum grows
+}
+
+bool QuantumTuning::readConfigKey(const std::string& key, std::istream& in) {
+    if (key == "adaptive-quantum") in >> enabled;
+    else if (key == "quantum-min") in >> min_quantum;
+    else if (key == "quantum-max") in >> max_quantum;
+    else if (key == "quantum-window") in >> window;
+    else if (key == "quantum-max-overhead") in >> max_switch_overhead;
+    else if (key == "quantum-target-response") in >> target_response;
+    else return false;
+    return true;
+}
+
+QuantumController::QuantumController() {}
+
+void QuantumController::configure(const QuantumTuning& new_tuning, int base_quantum, int switch_ticks) {
+    bool was_enabled = tuning.enabled;
+    tuning = new_tuning;
+    base = std::max(1, base_quantum);
+    switch_cost = std::max(0, switch_ticks);
+    if (!tuning.enabled) {
+        current = base;
+    } else if (!was_enabled) {
+        current = std::min(std::max(base, minQuantum()), maxQuantum());
+    } else {
+        current = std::min(std::max(current, minQuantum()), maxQuantum());
+    }
+}
+
+int QuantumController::minQuantum() const {
+    return std::max(1, tuning.min_quantum);
+}
+
+int QuantumController::maxQuantum() const {
+    int upper = tuning.max_quantum > 0 ? tuning.max_quantum : base * 8;
+    return std::max(minQuantum(), upper);
+}
+
+bool QuantumController::record(int process_id, int cycles_used, bool expired, size_t queue_depth, long long now) {
+    if (process_id != last_process) {
+        ++window_switches;
+        ++total_switches;
+        last_process = process_id;
+    }
+    ++dispatches;
+    window_ticks += cycles_used;
+    if (expired) {
+        ++expirations;
+    } else if (cycles_used > 0) {
+        burst_estimate = burst_estimate == 0.0
+            ? cycles_used
+            : kBurstSmoothing * cycles_used + (1.0 - kBurstSmoothing) * burst_estimate;
+    }
+
+    if (!tuning.enabled || dispatches < std::max(1, tuning.window)) {
+        return false;
+    }
+    int before = current;
+    retune(queue_depth, now);
+    return current != before;
+}
+
+void QuantumController::retune(size_t queue_depth, long long now) {
+    last_expire_rate = static_cast<double>(expirations) / dispatches;
+
+    double target = current;
+    if (last_expire_rate > kExpireThreshold) {
+        target = current * 1.5 + 1;
+    } else if (burst_estimate > 0.0) {
+        target = burst_estimate * kBurstHeadroom;
+    }
+
+    // Depth x quantum bounds how long a queued process waits for its next turn
+    if (tuning.target_response > 0 && queue_depth > 0) {
+        target = std::min(target, static_cast<double>(tuning.target_response) / queue_depth);
+    }
+
+    // cost / (quantum + cost) <= limit  <=>  quantum >= cost * (1 - limit) / limit
+    double limit = tuning.max_switch_overhead;
+    if (limit > 0.0 && limit < 1.0 && switch_cost > 0) {
+        double lost = static_cast<double>(window_switches) * switch_cost;
+        if (lost / (window_ticks + lost) > limit) {
+            target = std::max(target, switch_cost * (1.0 - limit) / limit);
+        }
+    }
+
+    // Move halfway so one odd window does not swing the quantum end to end
+    int next = static_cast<int>(std::lround(0.5 * (current + target)));
+    if (next == current && std::lround(target) != current) {
+        next += target > current ? 1 : -1;
+    }
+    next = std::min(std::max(next, minQuantum()), maxQuantum());
+
+    if (next != current) {
+        current = next;
+        changes.push_back(Change{now, current});
+        if (changes.size() > kHistoryLength) changes.pop_front();
+    }
+
+    dispatches = 0;
+    expirations = 0;
+    window_switches = 0;
+    window_ticks = 0;
+}
@@ -0,0 +1,75 @@
+#ifndef QUANTUM_CONTROLLER_H
+#define QUANTUM_CONTROLLER_H
+
+#include <deque>
+#include <istream>
+#include <string>
+
+// Adaptive quantum settings read from config.txt (see readConfigKey for the key names)
+struct QuantumTuning {
+    bool enabled = false;             // adaptive-quantum
+    int min_quantum = 1;              // quantum-min
+    int max_quantum = 0;              // quantum-max; 0 means 8x quantum-cycles
+    int window = 8;                   // quantum-window: dispatches between adjustments
+    double max_switch_overhead = 0.1; // quantum-max-overhead: share of core time switches may cost
+    int target_response = 0;          // quantum-target-response: ticks per round robin pass; 0 disables
+
+    // Consumes the value of a tuning key; returns false if the key is not ours
+    bool readConfigKey(const std::string& key, std::istream& in);
+};
+
+// Picks one core's quantum from what it has observed over the last window of dispatches:
+//  - typical CPU burst: cover most bursts so short jobs finish in one dispatch,
+//  - quantum expirations: bursts keep outgrowing the quantum, so grow it,
+//  - context-switch overhead: keep charged switch cost under max_switch_overhead of core time,
+//  - ready queue depth: keep one pass over the queue under target_response ticks.
+// Not thread-safe; the scheduler calls it with its mtx held.
+class QuantumController {
+public:
+    struct Change {
+        long long tick;   // Core ticks (active + idle) when the quantum changed
+        int quantum;
+    };
+
+    QuantumController();
+
+    // Applies new settings; base_quantum is quantum-cycles, the fixed value and starting point,
+    // and switch_cost is the context-switch-ticks the scheduler charges per switch
+    void configure(const QuantumTuning& tuning, int base_quantum, int switch_cost);
+
+    int quantum() const { return current; }
+    bool enabled() const { return tuning.enabled; }
+    int minQuantum() const;
+    int maxQuantum() const;
+
+    // Records one dispatch of process_id that ran cycles_used ticks. Returns true when the
+    // quantum was retuned.
+    bool record(int process_id, int cycles_used, bool expired, size_t queue_depth, long long now);
+
+    double burstEstimate() const { return burst_estimate; }
+    double expireRate() const { return last_expire_rate; }
+    long long switches() const { return total_switches; }
+    const std::deque<Change>& history() const { return changes; }
+
+private:
+    void retune(size_t queue_depth, long long now);
+
+    QuantumTuning tuning;
+    int base = 1;
+    int switch_cost = 0;
+    int current = 1;
+    int last_process = -1;
+
+    // Current window
+    int dispatches = 0;
+    int expirations = 0;
+    int window_switches = 0;
+    long long window_ticks = 0;
+
+    double burst_estimate = 0.0;   // EWMA of bursts that ended before the quantum did
+    double last_expire_rate = 0.0;
+    long long total_switches = 0;
+    std::deque<Change> changes;    // Most recent quantum changes, oldest first
+};
+
+#endif // QUANTUM_CONTROLLER_H
@@ -0,0 +1,128 @@
+#include "reportWriter.h"
+#include "noticeBoard.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+const size_t kFileBufferSize = 1 << 20;
+
+long long fileSize(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+    return in ? static_cast<long long>(in.tellg()) : -1;
+}
+}
+
+ReportWriter::~ReportWriter() {
+    finish();
+}
+
+void ReportWriter::setRotation(size_t bytes, int keep) {
+    std::lock_guard<std::mutex> lock(mtx);
+    max_bytes = bytes;
+    keep_files = keep < 0 ? 0 : keep;
+}
+
+bool ReportWriter::submit(const std::string& path, Body body, bool announce) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping || jobs.size() >= max_queued) return false;
+        Job job;
+        job.path = path;
+        job.body = body;
+        job.announce = announce;
+        jobs.push_back(job);
+        if (!worker.joinable()) worker = std::thread(&ReportWriter::loop, this);
+    }
+    wake.notify_one();
+    return true;
+}
+
+size_t ReportWriter::queued() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return jobs.size() + (writing ? 1 : 0);
+}
+
+bool ReportWriter::stopped() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stopping;
+}
+
+void ReportWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void ReportWriter::loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return; // Stopping with nothing left to write
+        Job job = jobs.front();
+        jobs.pop_front();
+        writing = true;
+        lock.unlock();
+        write(job);
+        lock.lock();
+        writing = false;
+    }
+}
+
+void ReportWriter::write(const Job& job) {
+    auto started = std::chrono::steady_clock::now();
+    size_t limit;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        limit = max_bytes;
+    }
+    if (limit > 0 && fileSize(job.path) >= static_cast<long long>(limit)) rotate(job.path);
+
+    // The buffer has to be installed before the file is opened
+    file_buffer.resize(kFileBufferSize);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(&file_buffer[0], file_buffer.size());
+    out.open(job.path.c_str(), std::ios::app);
+    if (!out) {
+        notices().post("Could not open " + job.path + " for the report.");
+        return;
+    }
+    long long before = fileSize(job.path);
+    size_t rows = job.body(out);
+    out.close();
+    if (out.fail()) {
+        notices().post("Writing the report to " + job.path + " failed.");
+        return;
+    }
+
+    if (!job.announce) return;
+    long long bytes = fileSize(job.path) - std::max(0LL, before);
+    long long millis =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    std::ostringstream notice;
+    notice << "Report saved to " << job.path << " (" << rows << " process rows, " << bytes / 1024 << " KB in "
+           << millis << " ms).";
+    notices().post(notice.str());
+}
+
+void ReportWriter::rotate(const std::string& path) const {
+    int keep;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        keep = keep_files;
+    }
+    if (keep == 0) {
+        std::remove(path.c_str());
+        return;
+    }
+    std::remove((path + "." + std::to_string(keep)).c_str());
+    for (int i = keep - 1; i >= 1; --i) {
+        std::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+    }
+    std::rename(path.c_str(), (path + ".1").c_str());
+}
@@ -0,0 +1,72 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes reports on a background thread so report-util returns at once. Each report is
+// appended to its file through one large buffer as the body produces rows; nothing is built
+// up in memory first. Before a report is appended, a file already past the size limit is
+// rotated: file -> file.1 -> file.2 ..., keeping the newest keep_files old copies.
+class ReportWriter {
+public:
+    // Writes one report to out and returns how many process rows it wrote
+    typedef std::function<size_t(std::ostream& out)> Body;
+
+    static const size_t kDefaultMaxBytes = 8 << 20;
+    static const int kDefaultKeepFiles = 3;
+    static const size_t kMaxQueued = 4;
+
+    // max_queued is how many reports may wait at once; writers with different kinds of
+    // output each get their own budget
+    explicit ReportWriter(size_t max_queued = kMaxQueued) : max_queued(max_queued) {}
+    ~ReportWriter();
+
+    void setRotation(size_t max_bytes, int keep_files);
+
+    // Queues a report; false if max_queued reports are already waiting or finish() has been
+    // called. Unless announce is false, a line saying where it went and how long it took is
+    // posted to the notice board when it is done.
+    bool submit(const std::string& path, Body body, bool announce = true);
+
+    size_t queued() const;
+    bool stopped() const; // finish() has been called; every later submit is refused
+
+    // Writes every queued report, then stops the thread for good: later submits are refused.
+    // The scheduler calls this before anything a queued body reads goes away.
+    void finish();
+
+private:
+    ReportWriter(const ReportWriter&);
+    ReportWriter& operator=(const ReportWriter&);
+
+    struct Job {
+        std::string path;
+        Body body;
+        bool announce;
+    };
+
+    void loop();
+    void write(const Job& job);
+    void rotate(const std::string& path) const;
+
+    const size_t max_queued;
+    size_t max_bytes = kDefaultMaxBytes;
+    int keep_files = kDefaultKeepFiles;
+    mutable std::mutex mtx;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;             // Started by the first submit
+    std::vector<char> file_buffer;  // Only touched by the worker
+};
+
+#endif // REPORT_WRITER_H
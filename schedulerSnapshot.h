@@ -0,0 +1,120 @@
+#ifndef SCHEDULER_SNAPSHOT_H
+#define SCHEDULER_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <map>
+#include "latencyHistogram.h"
+
+// Read-only copies of scheduler state. The scheduler publishes a new snapshot at a fixed
+// interval and viewers only ever read a published one, so they never take the scheduler lock.
+
+struct CoreSnapshot {
+    int core_id = 0;
+    bool busy = false;
+    int process_id = -1;
+    std::string process_name;
+    int ready_length = 0;       // Processes waiting in this core's ready queue
+    long long active_ticks = 0;
+    long long idle_ticks = 0;
+    int quantum = 0;
+    long long switches = 0, migrations = 0, steals = 0;
+    long long warm_dispatches = 0, cold_dispatches = 0;
+    long long overhead_ticks = 0;     // Lost to switches, migrations and cache reloads
+    long long tlb_hits = 0, tlb_misses = 0, tlb_miss_ticks = 0;
+};
+
+struct ProcessSnapshot {
+    int id = 0;
+    std::string name;
+    int core_id = 0;
+    int current_step = 0;       // Also the CPU ticks the process has used
+    int total_instructions = 0;
+    int memory = 0;
+    int priority = 0;
+    bool running = false;
+    bool in_memory = false;
+    int resident_bytes = 0;
+    int working_set = 0;        // Pages; 0 without paging
+    long long page_faults = 0;
+    double fault_rate = 0.0;    // Faults per 100 instructions
+
+    // The rest of what process-smi shows for a single process
+    bool finished = false;
+    long long deadline = 0;     // Ticks after arrival; 0 for best-effort work
+    bool realtime = false;
+    int program = 0;
+    int shared_pages = 0, shared_mapped = 0;
+    long long cow_faults = 0;
+    int resident_pages = 0;
+    int pages = 0;              // Size of the page table; 0 without paging
+};
+
+struct MemorySnapshot {
+    int max_memory = 0;
+    int used_memory = 0;
+    int mem_per_frame = 0;
+    int huge_ratio = 0;
+    int external_fragmentation = 0;
+    int total_frames = 0;
+    int frames_in_use = 0;
+    int committed_frames = 0;
+    bool paging = false;
+    long long page_faults = 0, evictions = 0;
+    double recent_fault_rate = 0.0;   // Faults per 100 references
+    long long disk_writes = 0, disk_reads = 0;
+    long long pool_capacity = 0, pool_used = 0, pool_pages = 0;
+    long long pool_stores = 0, pool_loads = 0;
+    long long prefetched = 0, prefetch_hits = 0;
+    long long cow_faults = 0;
+};
+
+// The EDF class: processes admitted by the utilization test, and how their deadlines went
+struct RealTimeStats {
+    long long admitted = 0;
+    long long rejected = 0;     // Had a deadline but did not fit; ran as best-effort work
+    long long finished = 0;
+    long long missed = 0;
+    long long ticks = 0;        // Core ticks spent running real-time processes
+    double reserved = 0.0;      // Utilization held by live real-time processes, summed over cores
+    LatencyHistogram lateness;  // Ticks past the deadline at finish; 0 when on time
+};
+
+// Latency of the finished processes of one priority
+struct PriorityLatency {
+    LatencyHistogram response, turnaround;
+};
+
+struct SchedulerSnapshot {
+    unsigned long long sequence = 0;
+    std::chrono::system_clock::time_point taken_at;
+
+    int num_cores = 0;
+    int quantum_cycles = 0;
+    std::vector<CoreSnapshot> cores;
+
+    size_t ready_count = 0;
+    size_t process_count = 0;   // Live (unfinished) processes
+    size_t finished_count = 0;
+
+    int max_memory = 0;
+    int used_memory = 0;
+    int mem_per_frame = 0;
+    std::string memory_map;     // One cell per frame group: '#' full, '+' partial, '.' free
+    int huge_ratio = 0;
+    MemorySnapshot memory;
+
+    size_t pending_count = 0;   // Waiting for admission
+    size_t swap_queue_depth = 0;
+    long long admitted = 0, swapped_out = 0, swapped_in = 0, suspended = 0;
+
+    // Over finished processes, in ticks
+    LatencyHistogram turnaround, waiting, response;
+    std::map<int, PriorityLatency> by_priority;
+    RealTimeStats realtime;
+
+    std::vector<ProcessSnapshot> top_processes; // Highest CPU use first
+};
+
+#endif // SCHEDULER_SNAPSHOT_H
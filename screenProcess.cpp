@@ -4,21 +4,30 @@
 #include <thread>
 #include <ctime>
 #include <iostream>
+#include <vector>
 
-ScreenProcess::ScreenProcess(const std::string& name) : processName(name) {}
+ScreenProcess::ScreenProcess(const std::string& name, bool flushOnExit) : processName(name), flushOnExit(flushOnExit) {}
 
 void ScreenProcess::execute() {
-    std::string filename = processName + ".txt"; // Generate filename based on process name
-    writeToFile(filename); // Call the private method to write to file
+    for (int i = 0; i < 100; ++i) {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::string line = std::string("Welcome to CSOPESY command line! ") + std::ctime(&now); // Log with timestamp
+        line.erase(line.size() - 1); // ctime ends with a newline
+        output.append(line);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Simulate work delay
+    }
+    if (flushOnExit) {
+        writeToFile(processName + ".txt"); // Generate filename based on process name
+    }
 }
 
+// One write of everything the ring kept, after the process is done
 void ScreenProcess::writeToFile(const std::string& filename) {
     std::ofstream processFile(filename);
     if (processFile.is_open()) {
-        for (int i = 0; i < 100; ++i) {
-            auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-            processFile << "Welcome to CSOPESY command line! " << std::ctime(&now); // Log with timestamp
-            std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Simulate work delay
+        std::vector<std::string> lines = output.recent(OutputRing::kDefaultCapacity);
+        for (const auto& line : lines) {
+            processFile << line << "\n";
         }
         processFile.close();
     } else {
@@ -2,14 +2,18 @@
 #define SCREEN_PROCESS_H
 
 #include <string>
+#include "outputRing.h"
 
 class ScreenProcess {
 public:
-    explicit ScreenProcess(const std::string& name); // Constructor with process name
+    explicit ScreenProcess(const std::string& name, bool flushOnExit = false); // Constructor with process name
     void execute(); // Public method to start the process execution
+    const OutputRing& getOutput() const { return output; } // Recent output, without touching the file
 
 private:
     std::string processName; // Member variable to store process name
+    bool flushOnExit;        // Write the output to <name>.txt once execute() is done
+    OutputRing output;       // Lines printed so far, newest kDefaultCapacity kept
     void writeToFile(const std::string& filename); // Private method to write output to a file
 };
 
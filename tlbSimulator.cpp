@@ -0,0 +1,59 @@
+#include "tlbSimulator.h"
+#include <algorithm>
+
+Tlb::Tlb() {}
+
+Tlb::Tlb(int entries, int ways) {
+    reconfigure(entries, ways);
+}
+
+void Tlb::reconfigure(int entries, int new_ways) {
+    ways = std::max(1, new_ways);
+    set_count = entries > 0 ? std::max(1, entries / ways) : 0;
+    slots.assign(static_cast<size_t>(set_count) * ways, Entry());
+}
+
+bool Tlb::lookup(int asid, int page) {
+    if (!enabled()) return true;
+    ++clock;
+    Entry* set = setFor(page);
+    Entry* victim = set;
+    for (int way = 0; way < ways; ++way) {
+        Entry& entry = set[way];
+        if (entry.asid == asid && entry.page == page) {
+            entry.last_use = clock;
+            ++counters.hits;
+            return true;
+        }
+        // Empty ways have last_use 0, so they are filled before anything is evicted
+        if (entry.last_use < victim->last_use) victim = &entry;
+    }
+    ++counters.misses;
+    victim->asid = asid;
+    victim->page = page;
+    victim->last_use = clock;
+    return false;
+}
+
+void Tlb::flush() {
+    if (!enabled()) return;
+    std::fill(slots.begin(), slots.end(), Entry());
+    ++counters.flushes;
+}
+
+void Tlb::invalidate(int asid, int page) {
+    if (!enabled()) return;
+    Entry* set = setFor(page);
+    for (int way = 0; way < ways; ++way) {
+        if (set[way].asid == asid && set[way].page == page) {
+            set[way] = Entry();
+            ++counters.invalidations;
+            return;
+        }
+    }
+}
+
+double Tlb::hitRate() const {
+    long long total = counters.hits + counters.misses;
+    return total > 0 ? 100.0 * counters.hits / total : 0.0;
+}
@@ -0,0 +1,54 @@
+#ifndef TLB_SIMULATOR_H
+#define TLB_SIMULATOR_H
+
+#include <vector>
+#include <cstddef>
+
+struct TlbStats {
+    long long hits = 0;
+    long long misses = 0;
+    long long flushes = 0;        // Whole-TLB flushes on untagged context switches
+    long long invalidations = 0;  // Single entries dropped because their page was evicted
+};
+
+// Set-associative translation cache for one simulated core, with LRU replacement inside
+// each set. Entries are tagged with an address space id, so a core can keep translations
+// for several processes, or flush on every switch to model an untagged TLB.
+// Not thread-safe; the scheduler calls it with its mtx held.
+class Tlb {
+public:
+    Tlb();
+    Tlb(int entries, int ways);
+
+    // Changes the geometry; contents are dropped, statistics are kept
+    void reconfigure(int entries, int ways);
+
+    bool enabled() const { return set_count > 0; }
+    int entries() const { return set_count * ways; }
+    int associativity() const { return ways; }
+
+    // Translates one access; returns true on a hit. A miss installs the translation.
+    bool lookup(int asid, int page);
+    void flush();
+    void invalidate(int asid, int page);
+
+    const TlbStats& stats() const { return counters; }
+    double hitRate() const;
+
+private:
+    struct Entry {
+        int asid = -1;                // -1 marks an empty way
+        int page = 0;
+        unsigned long long last_use = 0;
+    };
+
+    Entry* setFor(int page) { return &slots[static_cast<size_t>(page % set_count) * ways]; }
+
+    int set_count = 0;
+    int ways = 1;
+    std::vector<Entry> slots;         // set_count * ways, one set after another
+    unsigned long long clock = 0;     // Access counter for LRU
+    TlbStats counters;
+};
+
+#endif // TLB_SIMULATOR_H
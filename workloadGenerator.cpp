@@ -0,0 +1,273 @@
+#include "workloadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+static uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+FastRandom::FastRandom(uint64_t seed) {
+    // Expand the seed so that nearby seeds (e.g. thread ids) give unrelated streams
+    s0 = splitMix64(seed);
+    s1 = splitMix64(seed);
+    if (s0 == 0 && s1 == 0) s1 = 1;
+}
+
+uint64_t FastRandom::next() {
+    uint64_t x = s0;
+    const uint64_t y = s1;
+    s0 = y;
+    x ^= x << 23;
+    s1 = x ^ y ^ (x >> 17) ^ (y >> 26);
+    return s1 + y;
+}
+
+double FastRandom::nextDouble() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0); // 53 random bits
+}
+
+double FastRandom::nextGaussian() {
+    double u1 = nextDouble();
+    double u2 = nextDouble();
+    if (u1 < 1e-300) u1 = 1e-300;
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+int FastRandom::nextInt(int min_value, int max_value) {
+    if (max_value <= min_value) return min_value;
+    uint64_t range = static_cast<uint64_t>(max_value - min_value) + 1;
+    return min_value + static_cast<int>(next() % range);
+}
+
+FastRandom& FastRandom::threadLocal() {
+    thread_local FastRandom rng(
+        static_cast<uint64_t>(std::random_device{}()) ^
+        (static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) << 1) ^
+        static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    return rng;
+}
+
+bool parseArrivalModel(const std::string& name, ArrivalModel& model) {
+    if (name == "uniform") model = ArrivalModel::Uniform;
+    else if (name == "poisson") model = ArrivalModel::Poisson;
+    else if (name == "bursty") model = ArrivalModel::Bursty;
+    else return false;
+    return true;
+}
+
+bool parseSizeModel(const std::string& name, SizeModel& model) {
+    if (name == "uniform") model = SizeModel::Uniform;
+    else if (name == "lognormal") model = SizeModel::LogNormal;
+    else if (name == "pareto") model = SizeModel::Pareto;
+    else if (name == "bimodal") model = SizeModel::Bimodal;
+    else return false;
+    return true;
+}
+
+// Config values may be quoted, e.g. arrival-dist "poisson"
+static std::string readName(std::istream& in) {
+    std::string value;
+    in >> value;
+    value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+    return value;
+}
+
+// "0:1,30:9" -> {0, 1}, {30, 9}; malformed pairs and non-positive weights are skipped
+static void readPriorities(std::istream& in, std::vector<std::pair<int, double>>& priorities) {
+    std::string list = readName(in);
+    std::replace(list.begin(), list.end(), ',', ' ');
+    std::istringstream pairs(list);
+    priorities.clear();
+    std::string pair;
+    while (pairs >> pair) {
+        size_t colon = pair.find(':');
+        if (colon == std::string::npos) continue;
+        int priority = std::atoi(pair.substr(0, colon).c_str());
+        double weight = std::atof(pair.substr(colon + 1).c_str());
+        if (weight <= 0.0) continue;
+        priority = std::max(kMinPriority, std::min(kMaxPriority, priority));
+        priorities.push_back(std::make_pair(priority, weight));
+    }
+}
+
+// Distribution shapes outside their domain keep the previous value: the Pareto sampler divides
+// by alpha, and a negative sigma is not a lognormal
+static void readShape(std::istream& in, double& shape, bool zero_allowed) {
+    double value;
+    if (!(in >> value)) return;
+    if (value > 0.0 || (zero_allowed && value == 0.0)) shape = value;
+}
+
+bool WorkloadSettings::readConfigKey(const std::string& key, std::istream& in) {
+    if (key == "arrival-dist") parseArrivalModel(readName(in), arrival_model);
+    else if (key == "arrival-rate") in >> arrival_rate;
+    else if (key == "burst-factor") in >> burst_factor;
+    else if (key == "burst-prob") in >> burst_prob;
+    else if (key == "burst-length") in >> burst_length;
+    else if (key == "ins-dist") parseSizeModel(readName(in), ins_model);
+    else if (key == "ins-sigma") readShape(in, ins_sigma, true);
+    else if (key == "ins-alpha") readShape(in, ins_alpha, false);
+    else if (key == "ins-bimodal-mix") in >> ins_bimodal_mix;
+    else if (key == "mem-dist") parseSizeModel(readName(in), mem_model);
+    else if (key == "mem-sigma") readShape(in, mem_sigma, true);
+    else if (key == "mem-alpha") readShape(in, mem_alpha, false);
+    else if (key == "mem-bimodal-mix") in >> mem_bimodal_mix;
+    else if (key == "programs") in >> programs;
+    else if (key == "priority-dist") readPriorities(in, priorities);
+    else if (key == "rt-share") in >> rt_share;
+    else if (key == "rt-slack") in >> rt_slack;
+    else return false;
+    return true;
+}
+
+SizeDistribution::SizeDistribution(SizeModel model, int min_value, int max_value,
+                                   double sigma, double alpha, double bimodal_mix)
+    : model(model), min_value(min_value), max_value(std::max(min_value, max_value)),
+      sigma(sigma), alpha(alpha), bimodal_mix(bimodal_mix) {
+    double lo = std::max(1, min_value);
+    double hi = std::max(1, this->max_value);
+    mu = 0.5 * (std::log(lo) + std::log(hi));
+}
+
+int SizeDistribution::sample(FastRandom& rng) const {
+    if (max_value <= min_value) return min_value;
+
+    double value;
+    switch (model) {
+        case SizeModel::LogNormal:
+            value = std::exp(mu + sigma * rng.nextGaussian());
+            break;
+        case SizeModel::Pareto: {
+            // Heavy tail starting at min_value; inverse-CDF sampling
+            double u = 1.0 - rng.nextDouble();
+            value = std::max(1, min_value) / std::pow(u, 1.0 / alpha);
+            break;
+        }
+        case SizeModel::Bimodal: {
+            // Two modes, each spanning a tenth of the range at either end
+            int width = std::max(1, (max_value - min_value) / 10);
+            if (rng.nextDouble() < bimodal_mix) {
+                return rng.nextInt(min_value, min_value + width);
+            }
+            return rng.nextInt(max_value - width, max_value);
+        }
+        default:
+            return rng.nextInt(min_value, max_value);
+    }
+
+    if (value < min_value) return min_value;
+    if (value > max_value) return max_value;
+    return static_cast<int>(value);
+}
+
+ArrivalProcess::ArrivalProcess(ArrivalModel model, double rate, double burst_factor,
+                               double burst_prob, double burst_length)
+    : model(model), rate(std::max(0.0, rate)), burst_factor(burst_factor), burst_prob(burst_prob),
+      burst_end_prob(burst_length > 1.0 ? 1.0 / burst_length : 1.0) {}
+
+long long ArrivalProcess::poisson(FastRandom& rng, double lambda) {
+    if (lambda <= 0.0) return 0;
+    if (lambda < 30.0) {
+        // Knuth's method; only a handful of iterations at this size
+        double limit = std::exp(-lambda);
+        double product = rng.nextDouble();
+        long long count = 0;
+        while (product > limit) {
+            ++count;
+            product *= rng.nextDouble();
+        }
+        return count;
+    }
+    // Normal approximation keeps large rates O(1) per tick
+    double value = lambda + std::sqrt(lambda) * rng.nextGaussian() + 0.5;
+    return value < 0.0 ? 0 : static_cast<long long>(value);
+}
+
+long long ArrivalProcess::sample(FastRandom& rng) {
+    switch (model) {
+        case ArrivalModel::Poisson:
+            return poisson(rng, rate);
+        case ArrivalModel::Bursty:
+            if (in_burst) {
+                if (rng.nextDouble() < burst_end_prob) in_burst = false;
+            } else if (rng.nextDouble() < burst_prob) {
+                in_burst = true;
+            }
+            return poisson(rng, in_burst ? rate * burst_factor : rate);
+        default: {
+            double expected = rate + fractional;
+            long long count = static_cast<long long>(expected);
+            fractional = expected - count;
+            return count;
+        }
+    }
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadSettings& settings, int min_ins, int max_ins,
+                                     int min_mem, int max_mem)
+    : arrivals(settings.arrival_model, settings.arrival_rate, settings.burst_factor,
+               settings.burst_prob, settings.burst_length),
+      instructions(settings.ins_model, min_ins, max_ins, settings.ins_sigma, settings.ins_alpha,
+                   settings.ins_bimodal_mix),
+      memory(settings.mem_model, min_mem, max_mem, settings.mem_sigma, settings.mem_alpha,
+             settings.mem_bimodal_mix),
+      memory_from_instructions(max_mem <= 0),
+      programs(static_cast<size_t>(std::max(0, settings.programs)), ProcessSpec()),
+      rt_share(settings.rt_share), rt_slack(std::max(1.0, settings.rt_slack)) {
+    double total = 0.0;
+    for (const auto& entry : settings.priorities) {
+        total += entry.second;
+        priorities.push_back(std::make_pair(entry.first, total));
+    }
+}
+
+int WorkloadGenerator::samplePriority(FastRandom& rng) const {
+    if (priorities.empty()) return kDefaultPriority;
+    double pick = rng.nextDouble() * priorities.back().second;
+    for (const auto& entry : priorities) {
+        if (pick < entry.second) return entry.first;
+    }
+    return priorities.back().first;
+}
+
+long long WorkloadGenerator::sampleDeadline(FastRandom& rng, int instructions) const {
+    if (rt_share <= 0.0 || rng.nextDouble() >= rt_share) return 0;
+    return std::max(1LL, static_cast<long long>(std::ceil(instructions * rt_slack)));
+}
+
+ProcessSpec WorkloadGenerator::sample(FastRandom& rng) {
+    int program = programs.empty() ? -1 : rng.nextInt(0, static_cast<int>(programs.size()) - 1);
+    if (program >= 0 && programs[program].program >= 0) {
+        ProcessSpec spec = programs[program];
+        spec.priority = samplePriority(rng);
+        spec.deadline = sampleDeadline(rng, spec.instructions);
+        return spec;
+    }
+    ProcessSpec spec;
+    spec.instructions = instructions.sample(rng);
+    spec.memory = memory_from_instructions ? spec.instructions : memory.sample(rng);
+    spec.program = program;
+    spec.priority = samplePriority(rng);
+    spec.deadline = sampleDeadline(rng, spec.instructions);
+    if (program >= 0) programs[program] = spec;
+    return spec;
+}
+
+void WorkloadGenerator::generateBatch(std::vector<ProcessSpec>& batch) {
+    FastRandom& rng = FastRandom::threadLocal();
+    long long count = arrivals.sample(rng);
+
+    batch.resize(static_cast<size_t>(count));
+    for (auto& spec : batch) {
+        spec = sample(rng);
+    }
+}
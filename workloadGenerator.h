@@ -0,0 +1,129 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small xorshift128+ generator; much cheaper than rand() and has no shared state
+class FastRandom {
+public:
+    explicit FastRandom(uint64_t seed);
+
+    uint64_t next();
+    double nextDouble();                    // Uniform in [0, 1)
+    double nextGaussian();                  // Standard normal (Box-Muller)
+    int nextInt(int min_value, int max_value); // Uniform in [min_value, max_value]
+
+    static FastRandom& threadLocal();       // One generator per thread, seeded on first use
+
+private:
+    uint64_t s0, s1;
+};
+
+// Process priorities, nice-style: lower values are more urgent
+const int kMinPriority = 0;
+const int kMaxPriority = 39;
+const int kDefaultPriority = 20;
+
+enum class ArrivalModel { Uniform, Poisson, Bursty };
+enum class SizeModel { Uniform, LogNormal, Pareto, Bimodal };
+
+bool parseArrivalModel(const std::string& name, ArrivalModel& model);
+bool parseSizeModel(const std::string& name, SizeModel& model);
+
+// Distribution settings read from config.txt (see readConfigKey for the key names)
+struct WorkloadSettings {
+    ArrivalModel arrival_model = ArrivalModel::Uniform;
+    double arrival_rate = 1.0;       // Mean arrivals per generator tick
+    double burst_factor = 10.0;      // Rate multiplier while a burst is active
+    double burst_prob = 0.05;        // Chance per tick of a burst starting
+    double burst_length = 5.0;       // Mean burst length in ticks
+
+    SizeModel ins_model = SizeModel::Uniform;
+    double ins_sigma = 1.0;          // Lognormal shape, >= 0
+    double ins_alpha = 1.5;          // Pareto shape, > 0
+    double ins_bimodal_mix = 0.8;    // Share of the small mode
+
+    SizeModel mem_model = SizeModel::Uniform;
+    double mem_sigma = 1.0;
+    double mem_alpha = 1.5;
+    double mem_bimodal_mix = 0.8;
+
+    int programs = 0;                // Distinct programs processes are drawn from; 0 makes every process unique
+
+    // priority-dist "0:1,30:9": priority:weight pairs new processes draw from; empty gives every
+    // process kDefaultPriority
+    std::vector<std::pair<int, double>> priorities;
+
+    double rt_share = 0.0;           // Share of new processes with a deadline, for the EDF class
+    double rt_slack = 4.0;           // Their relative deadline: instructions * rt_slack ticks
+
+    // Consumes the value of a workload key; returns false if the key is not ours
+    bool readConfigKey(const std::string& key, std::istream& in);
+};
+
+// Samples a size in [min_value, max_value] from one of the SizeModel shapes
+class SizeDistribution {
+public:
+    SizeDistribution(SizeModel model, int min_value, int max_value,
+                     double sigma, double alpha, double bimodal_mix);
+
+    int sample(FastRandom& rng) const;
+
+private:
+    SizeModel model;
+    int min_value, max_value;
+    double sigma, alpha, bimodal_mix;
+    double mu; // Lognormal location, centred on the geometric mean of the range
+};
+
+// Number of arrivals in one tick; Bursty is a two-state (on/off) modulated Poisson process
+class ArrivalProcess {
+public:
+    ArrivalProcess(ArrivalModel model, double rate, double burst_factor, double burst_prob, double burst_length);
+
+    long long sample(FastRandom& rng);
+
+private:
+    ArrivalModel model;
+    double rate, burst_factor, burst_prob, burst_end_prob;
+    bool in_burst = false;
+    double fractional = 0.0; // Carry for non-integer Uniform rates
+
+    static long long poisson(FastRandom& rng, double lambda);
+};
+
+struct ProcessSpec {
+    int instructions = 0;
+    int memory = 0;
+    int program = -1; // Processes of the same program have the same size and can share pages
+    int priority = kDefaultPriority;
+    long long deadline = 0; // Relative deadline in ticks; 0 for best-effort work
+};
+
+class WorkloadGenerator {
+public:
+    // min_mem/max_mem of 0 keep the old behaviour of sizing memory by instruction count
+    WorkloadGenerator(const WorkloadSettings& settings, int min_ins, int max_ins, int min_mem, int max_mem);
+
+    // Fills batch with every arrival of one tick; the vector is reused between calls
+    void generateBatch(std::vector<ProcessSpec>& batch);
+
+private:
+    ProcessSpec sample(FastRandom& rng);
+    int samplePriority(FastRandom& rng) const;
+    long long sampleDeadline(FastRandom& rng, int instructions) const;
+
+    ArrivalProcess arrivals;
+    SizeDistribution instructions;
+    SizeDistribution memory;
+    bool memory_from_instructions;
+    std::vector<ProcessSpec> programs; // Sized on first use of each program
+    std::vector<std::pair<int, double>> priorities; // Cumulative weights
+    double rt_share, rt_slack;
+};
+
+#endif // WORKLOAD_GENERATOR_H